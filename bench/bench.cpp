@@ -0,0 +1,1022 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "branch_random.hpp"
+#include "camera.hpp"
+#include "cherry_blossom.hpp"
+#include "direction_table.hpp"
+#include "growth_journal.hpp"
+#include "image.hpp"
+#include "lsystem.hpp"
+#include "impostor_cache.hpp"
+#include "node.hpp"
+#include "node_visitor.hpp"
+#include "species.hpp"
+#include "sprite_batch.hpp"
+#include "texture_loader.hpp"
+#include "tree_file.hpp"
+#include "transform_pass.hpp"
+#include "tree_grower.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+//fixed, so the results can be compared across commits
+constexpr std::uint64_t benchSeed = 12345;
+constexpr int benchRuns = 5;
+
+//-------------------------
+//allocation tracking
+//-------------------------
+
+//every allocation carries its size & the start of its block in front of it, so the live heap can be tracked
+struct AllocationHeader {
+	char* block;
+	std::size_t size;
+};
+static std::atomic<std::int64_t> allocationCount(0);
+static std::atomic<std::int64_t> liveBytes(0);
+static std::atomic<std::int64_t> peakBytes(0);
+
+//every form of new & delete goes through these, the arrays and over-aligned types included
+static void* allocateTracked(std::size_t size, std::size_t alignment) {
+	//malloc() is already aligned this far, any more is padding in front of the header
+	alignment = std::max(alignment, alignof(std::max_align_t));
+	char* block = static_cast<char*>(std::malloc(size + sizeof(AllocationHeader) + alignment - alignof(std::max_align_t)));
+	if (!block) {
+		throw(std::bad_alloc());
+	}
+	std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(block) + sizeof(AllocationHeader) + alignment - 1) / alignment * alignment;
+	char* ptr = reinterpret_cast<char*>(address);
+	reinterpret_cast<AllocationHeader*>(ptr)[-1] = {block, size};
+
+	allocationCount++;
+	std::int64_t live = liveBytes += size;
+	std::int64_t peak = peakBytes.load();
+	while (live > peak && !peakBytes.compare_exchange_weak(peak, live));
+
+	return ptr;
+}
+
+static void freeTracked(void* ptr) noexcept {
+	if (!ptr) {
+		return;
+	}
+	AllocationHeader header = static_cast<AllocationHeader*>(ptr)[-1];
+	liveBytes -= header.size;
+	std::free(header.block);
+}
+
+void* operator new(std::size_t size) {
+	return allocateTracked(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+	return allocateTracked(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return allocateTracked(size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return allocateTracked(size, std::size_t(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+	freeTracked(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+	freeTracked(ptr);
+}
+
+//the whole process, in kilobytes
+long peakResidentMemory() {
+#if defined(__linux__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#elif defined(__APPLE__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024;
+#else
+	return 0;
+#endif
+}
+
+//-------------------------
+//measurement
+//-------------------------
+
+struct Result {
+	std::string name;
+	int treeNodes; //size of the tree at the start of a run
+	long long ops; //operations per run
+	long long nodes; //nodes created, visited or removed per run
+	double ms; //best run
+	long long allocations; //worst run
+	long long peakHeap; //bytes above the heap at the start of a run, worst run
+};
+
+std::vector<Result> results;
+
+//setup() runs untimed before each run and returns the tree size, body() returns the nodes it processed
+//setup should hand the body fresh containers, or the allocations depend on the previous run
+void measure(std::string name, int runs, long long ops, std::function<int()> setup, std::function<long long()> body) {
+	Result result = {name, 0, ops, 0, 0, 0, 0};
+
+	for (int run = 0; run < runs; run++) {
+		result.treeNodes = setup();
+
+		std::int64_t allocations = allocationCount;
+		std::int64_t heap = liveBytes;
+		peakBytes = heap;
+
+		Clock::time_point start = Clock::now();
+		result.nodes = body();
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		result.ms = run == 0 || ms < result.ms ? ms : result.ms;
+		result.allocations = std::max<long long>(result.allocations, allocationCount - allocations);
+		result.peakHeap = std::max<long long>(result.peakHeap, peakBytes - heap);
+	}
+
+	results.push_back(result);
+	std::cerr << name << ": " << std::fixed << std::setprecision(2) << result.ms << " ms" << std::endl;
+}
+
+//keeps traversals from being optimized away
+volatile std::uint64_t sink;
+
+//-------------------------
+//trees
+//-------------------------
+
+//grow a bushy tree, every leaf sprouts twice
+void growBushy(NodeTree* tree, TreeGrower* grower, int length = 10) {
+	grower->Grow(tree, tree->GetLeaves(), [length](NodeTree* tree, NodeIndex leaf, std::vector<Sprout>* sprouts) {
+		Sprout branches[2];
+		int count = sproutBranch(tree, leaf, 50, 1, 10, branches);
+		for (int i = 0; i < count; i++) {
+			branches[i].length = length;
+		}
+		sprouts->insert(sprouts->end(), branches, branches + count);
+	});
+}
+
+//at least this many nodes, with longer branches for bigger trees
+//about one node per 8x8 pixels, like the example scene
+void growSpacedTree(NodeTree* tree, int target) {
+	int depth = 1;
+	while ((2 << depth) <= target) {
+		depth++;
+	}
+	int length = std::sqrt(target * 64.0) / depth;
+
+	tree->SetSeed(benchSeed);
+	TreeGrower grower;
+	while (tree->Size() < target) {
+		growBushy(tree, &grower, length);
+	}
+}
+
+//the layout of the tree, not just its shape
+std::uint64_t checksum(NodeTree* tree) {
+	std::uint64_t hash = 0;
+	for (NodeIndex i = 0; i < NodeIndex(tree->GetCapacity()) && i < NodeIndex(tree->Size()); i++) {
+		Node* node = tree->GetNode(i);
+		hash = hash * 31 + node->GetKey() + node->GetDirection() + node->GetParent();
+	}
+	return hash;
+}
+
+//the shape of the tree, whichever slots the nodes are in
+std::uint64_t shapeChecksum(NodeTree* tree) {
+	std::uint64_t hash = 0;
+	forEachNode(tree, tree->GetRoot(), [&](Node* node) -> int {
+		hash = hash * 31 + node->GetKey() + node->GetDirection() + node->GetNodeCount();
+		return Visit::CONTINUE;
+	});
+	return hash;
+}
+
+//fixed points spread over the area the tree covers
+std::vector<Vector2> pickPoints(NodeTree* tree, int count) {
+	BoundingBox bounds = BoundingBox::Nothing();
+	forEachNode(tree, tree->GetRoot(), [&](Node* node) -> int {
+		bounds.Expand(node->GetOrigin());
+		return Visit::CONTINUE;
+	});
+
+	std::vector<Vector2> points(count);
+	BranchRandom rng(benchSeed, count);
+	for (auto& it : points) {
+		it.x = bounds.minX + (bounds.maxX - bounds.minX) * (rng.Next() % 10000) / 10000.0;
+		it.y = bounds.minY + (bounds.maxY - bounds.minY) * (rng.Next() % 10000) / 10000.0;
+	}
+	return points;
+}
+
+//-------------------------
+//benchmarks
+//-------------------------
+
+//raw addChildNode throughput, four children per node
+void benchGeneration() {
+	constexpr int count = 1000000;
+	NodeTree tree;
+
+	measure("generation", benchRuns, count - 1, [&]() {
+		tree = NodeTree();
+		tree.Reserve(count);
+		return tree.Size();
+	}, [&]() {
+		for (int i = 1; i < count; i++) {
+			addChildNode(&tree, (i - 1) / 4, i * 7, 10);
+		}
+		return count - 1;
+	});
+}
+
+//one growth step over a large frontier, at each thread count
+void benchGrowthScaling() {
+	NodeTree base;
+	base.SetSeed(benchSeed);
+	TreeGrower serial(1);
+	while (base.GetLeafCount() < (1 << 18)) {
+		growBushy(&base, &serial);
+	}
+
+	//powers of two, then every core
+	int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<int> threadCounts;
+	for (int threads = 1; threads < maxThreads; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	std::uint64_t expected = 0;
+	for (auto& threads : threadCounts) {
+		TreeGrower grower(threads);
+		NodeTree tree;
+		int leaves = base.GetLeafCount();
+
+		measure("growth_step_threads_" + std::to_string(threads), benchRuns, leaves, [&]() {
+			tree = NodeTree(base);
+			return tree.Size();
+		}, [&]() {
+			growBushy(&tree, &grower);
+			return tree.Size() - base.Size();
+		});
+
+		//the result can't depend on the thread count
+		if (threads == 1) {
+			expected = checksum(&tree);
+		}
+		else if (checksum(&tree) != expected) {
+			std::cerr << "growth_step_threads_" << threads << ": MISMATCH against the single threaded result" << std::endl;
+		}
+	}
+}
+
+//visiting every node of a million node tree
+void benchTraversal() {
+	NodeTree tree;
+	tree.SetSeed(benchSeed);
+	TreeGrower grower;
+	while (tree.Size() < 1000000) {
+		growBushy(&tree, &grower);
+	}
+	auto setup = [&]() {
+		return tree.Size();
+	};
+
+	measure("traversal_pre_order", benchRuns, tree.Size(), setup, [&]() {
+		std::uint64_t sum = 0;
+		forEachNode(&tree, tree.GetRoot(), [&](Node* node) -> int {
+			sum += node->GetKey();
+			return Visit::CONTINUE;
+		});
+		sink = sum;
+		return tree.Size();
+	});
+
+	measure("traversal_post_order", benchRuns, tree.Size(), setup, [&]() {
+		std::uint64_t sum = 0;
+		forEachNodePostOrder(&tree, tree.GetRoot(), [&](Node* node) -> int {
+			sum += node->GetKey();
+			return Visit::CONTINUE;
+		});
+		sink = sum;
+		return tree.Size();
+	});
+
+	measure("traversal_breadth_first", benchRuns, tree.Size(), setup, [&]() {
+		std::uint64_t sum = 0;
+		forEachNodeBreadthFirst(&tree, tree.GetRoot(), [&](Node* node) -> int {
+			sum += node->GetKey();
+			return Visit::CONTINUE;
+		});
+		sink = sum;
+		return tree.Size();
+	});
+}
+
+//nearest node within 8 pixels of fixed points, the spatial grid against a full scan
+void benchPicking() {
+	constexpr int gridPicks = 100000;
+	constexpr int scanPicks = 20;
+
+	for (int target : {10000, 100000, 1000000}) {
+		NodeTree tree;
+		growSpacedTree(&tree, target);
+		std::vector<Vector2> points = pickPoints(&tree, gridPicks);
+		auto setup = [&]() {
+			return tree.Size();
+		};
+
+		measure("picking_grid_" + std::to_string(target), benchRuns, gridPicks, setup, [&]() {
+			int hits = 0;
+			for (auto& it : points) {
+				hits += tree.GetGrid()->FindNearest(it, 8) != NO_NODE;
+			}
+			sink = hits;
+			return 0;
+		});
+
+		//the way picking used to work
+		measure("picking_scan_" + std::to_string(target), 1, scanPicks, setup, [&]() {
+			int hits = 0;
+			for (int i = 0; i < scanPicks; i++) {
+				double best = 64;
+				NodeIndex selected = NO_NODE;
+				forEachNode(&tree, tree.GetRoot(), [&](Node* node) -> int {
+					double d = (points[i] - node->GetOrigin()).SquaredLength();
+					if (d <= best) {
+						best = d;
+						selected = tree.GetIndex(node);
+					}
+					return Visit::CONTINUE;
+				});
+				hits += selected != NO_NODE;
+			}
+			sink = hits;
+			return (long long)tree.Size() * scanPicks;
+		});
+	}
+}
+
+//gathering the nodes inside the camera's view of a million node tree, at several zoom levels
+void benchCulling() {
+	constexpr int frames = 100;
+
+	NodeTree tree;
+	growSpacedTree(&tree, 1000000);
+	BoundingBox bounds = tree.GetNode(tree.GetRoot())->GetBounds();
+	Vector2 center((bounds.minX + bounds.maxX) / 2, (bounds.minY + bounds.maxY) / 2);
+	auto setup = [&]() {
+		return tree.Size();
+	};
+
+	//the way drawing used to work
+	measure("culling_none", benchRuns, frames, setup, [&]() {
+		long long visited = 0;
+		for (int i = 0; i < frames; i++) {
+			forEachNode(&tree, tree.GetRoot(), [&](Node* node) -> int {
+				visited++;
+				return Visit::CONTINUE;
+			});
+		}
+		sink = visited;
+		return visited;
+	});
+
+	for (double zoom : {0.125, 1.0, 4.0}) {
+		Camera camera(800, 600);
+		camera.SetZoom(zoom);
+		camera.SetPosition(center - Vector2(400 / zoom, 300 / zoom));
+		BoundingBox view = camera.GetView();
+
+		std::ostringstream name;
+		name << "culling_zoom_" << zoom;
+		measure(name.str(), benchRuns, frames, setup, [&]() {
+			long long visited = 0;
+			for (int i = 0; i < frames; i++) {
+				forEachNodeInBox(&tree, tree.GetRoot(), view, [&](Node* node) -> int {
+					visited++;
+					return Visit::CONTINUE;
+				});
+			}
+			sink = visited;
+			return visited;
+		});
+	}
+}
+
+//drawing a million node plant zoomed out in software, node by node against impostors
+void benchDrawing() {
+	constexpr int frames = 5;
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 800, 600, 32, SDL_PIXELFORMAT_RGBA8888);
+	SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+	if (!renderer) {
+		std::cerr << "Skipping the drawing benchmarks; " << SDL_GetError() << std::endl;
+		return;
+	}
+
+	//the textures have to go before the renderer
+	{
+		Image blank;
+		blank.Create(renderer, 8, 8, {255, 255, 255, 255});
+		TextureLoader::CreateSingleton();
+		TextureHandle sprite = TextureLoader::GetSingleton().Store("sprite", std::move(blank));
+
+		//more images than the loader starts with room for, the early handles have to survive it growing
+		std::vector<TextureHandle> handles = {sprite};
+		for (int i = 0; i < 64; i++) {
+			Image filler;
+			filler.Create(renderer, 1, 1);
+			handles.push_back(TextureLoader::GetSingleton().Store("filler_" + std::to_string(i), std::move(filler)));
+		}
+		for (auto& handle : handles) {
+			if (SDL_QueryTexture(TextureLoader::GetSingleton().GetImage(handle)->GetTexture(), nullptr, nullptr, nullptr, nullptr)) {
+				std::cerr << "drawing: texture handle " << handle << " was freed by later loads; " << SDL_GetError() << std::endl;
+			}
+		}
+
+		//short branches, like the example plant, so the nodes pile up
+		NodeTree tree;
+		TreeGrower grower;
+		tree.SetSeed(benchSeed);
+		while (tree.Size() < 1000000) {
+			growBushy(&tree, &grower);
+		}
+		forEachNode(&tree, tree.GetRoot(), [&](Node* node) -> int {
+			node->SetSprite(sprite);
+			return Visit::CONTINUE;
+		});
+
+		BoundingBox bounds = tree.GetNode(tree.GetRoot())->GetBounds();
+		Vector2 center((bounds.minX + bounds.maxX) / 2, (bounds.minY + bounds.maxY) / 2);
+		SpriteBatch batch;
+
+		for (double zoom : {0.25, 0.5}) {
+			Camera camera(800, 600);
+			camera.SetZoom(zoom);
+			camera.SetPosition(center - Vector2(400 / zoom, 300 / zoom));
+			ImpostorCache impostors;
+			impostors.Create(renderer);
+
+			for (ImpostorCache* cache : {(ImpostorCache*)nullptr, &impostors}) {
+				std::ostringstream name;
+				name << (cache ? "drawing_impostors_zoom_" : "drawing_direct_zoom_") << zoom;
+
+				//ops are frames, nodes are the quads drawn
+				measure(name.str(), benchRuns, frames, [&]() {
+					//start from a warm cache
+					do {
+						impostors.NextFrame();
+						drawNodeTree(&batch, &tree, tree.GetRoot(), camera, 8, cache);
+						batch.Clear();
+					} while (cache && impostors.GetRedrawCount() > 0);
+					return tree.Size();
+				}, [&]() {
+					long long quads = 0;
+					for (int i = 0; i < frames; i++) {
+						impostors.NextFrame();
+						drawNodeTree(&batch, &tree, tree.GetRoot(), camera, 8, cache);
+						batch.Flush(renderer);
+						quads += batch.GetVertexCount() / 4;
+					}
+					return quads;
+				});
+			}
+		}
+	}
+
+	TextureLoader::DeleteSingleton();
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+}
+
+//a whole L-system bush at once, rewritten on one thread and then across a pool
+void benchLSystem() {
+	constexpr int iterations = 24; //about 1.4M nodes
+	NodeTree tree;
+	WorkerPool pool;
+
+	measure("lsystem_bush", benchRuns, 1, [&]() {
+		tree = NodeTree();
+		return tree.Size();
+	}, [&]() {
+		generateLSystemBush(&tree, iterations, benchSeed);
+		return tree.Size();
+	});
+
+	std::uint64_t single = checksum(&tree);
+
+	measure("lsystem_bush_pool", benchRuns, 1, [&]() {
+		tree = NodeTree();
+		return tree.Size();
+	}, [&]() {
+		generateLSystemBush(&tree, iterations, benchSeed, &pool);
+		return tree.Size();
+	});
+
+	if (checksum(&tree) != single) {
+		std::cerr << "lsystem_bush_pool: the tree depends on the thread count" << std::endl;
+	}
+}
+
+//the obvious serializer, for comparison: one record per node through a stream, rebuilt through the usual calls
+void saveNaive(NodeTree* tree, std::string fname) {
+	std::ofstream os(fname, std::ios::binary);
+	forEachNode(tree, tree->GetRoot(), [&](Node* node) -> int {
+		int type = node->GetType();
+		int direction = node->GetDirection();
+		int length = node->GetLength();
+		Vector2 origin = node->GetOrigin();
+		std::uint64_t key = node->GetKey();
+		int births = node->GetBirths();
+		int children = 0;
+		for (NodeIndex it = node->GetFirstChild(); it != NO_NODE; it = tree->GetNode(it)->GetNextSibling()) {
+			children++;
+		}
+
+		os.write(reinterpret_cast<char*>(&type), sizeof(type));
+		os.write(reinterpret_cast<char*>(&direction), sizeof(direction));
+		os.write(reinterpret_cast<char*>(&length), sizeof(length));
+		os.write(reinterpret_cast<char*>(&origin), sizeof(origin));
+		os.write(reinterpret_cast<char*>(&key), sizeof(key));
+		os.write(reinterpret_cast<char*>(&births), sizeof(births));
+		os.write(reinterpret_cast<char*>(&children), sizeof(children));
+		return Visit::CONTINUE;
+	});
+}
+
+void loadNaive(NodeTree* tree, std::string fname) {
+	std::ifstream is(fname, std::ios::binary);
+	tree->Clear();
+
+	//the parents still waiting for children, and how many
+	std::vector<std::pair<NodeIndex, int>> open;
+	while (is.peek() != EOF) {
+		int type, direction, length, births, children;
+		Vector2 origin;
+		std::uint64_t key;
+		is.read(reinterpret_cast<char*>(&type), sizeof(type));
+		is.read(reinterpret_cast<char*>(&direction), sizeof(direction));
+		is.read(reinterpret_cast<char*>(&length), sizeof(length));
+		is.read(reinterpret_cast<char*>(&origin), sizeof(origin));
+		is.read(reinterpret_cast<char*>(&key), sizeof(key));
+		is.read(reinterpret_cast<char*>(&births), sizeof(births));
+		is.read(reinterpret_cast<char*>(&children), sizeof(children));
+
+		NodeIndex index = tree->GetRoot();
+		if (!open.empty()) {
+			index = tree->CreateNode();
+			tree->AppendChild(open.back().first, index);
+			if (--open.back().second == 0) {
+				open.pop_back();
+			}
+		}
+
+		Node* node = tree->GetNode(index);
+		node->SetDirection(direction);
+		node->SetLength(length);
+		node->SetKey(key);
+		node->SetBirths(births);
+		tree->SetType(index, Node::Type(type));
+		tree->PlaceNode(index, origin);
+
+		if (children > 0) {
+			open.push_back({index, children});
+		}
+	}
+}
+
+//saving and reopening a large tree, the mapped file against a node at a time
+void benchTreeFiles() {
+	const std::string fname = "bench.tree";
+	const std::string naiveName = "bench.naive";
+
+	NodeTree base;
+	growSpacedTree(&base, 2000000);
+	NodeTree tree;
+
+	measure("save_tree_file", benchRuns, 1, [&]() {
+		return base.Size();
+	}, [&]() {
+		saveTree(&base, fname);
+		return base.Size();
+	});
+
+	measure("save_naive", benchRuns, 1, [&]() {
+		return base.Size();
+	}, [&]() {
+		saveNaive(&base, naiveName);
+		return base.Size();
+	});
+
+	//just the mapping, the arrays are usable from here
+	measure("open_tree_file", benchRuns, 1, [&]() {
+		return base.Size();
+	}, [&]() {
+		TreeFile file(fname);
+		sink = file.GetEnds()[0];
+		return file.Size();
+	});
+
+	measure("load_tree_file", benchRuns, 1, [&]() {
+		tree = NodeTree();
+		return tree.Size();
+	}, [&]() {
+		loadTree(&tree, fname);
+		return tree.Size();
+	});
+
+	//the slots are in depth first order now
+	if (shapeChecksum(&tree) != shapeChecksum(&base)) {
+		std::cerr << "load_tree_file: the loaded tree doesn't match" << std::endl;
+	}
+
+	measure("load_naive", benchRuns, 1, [&]() {
+		tree = NodeTree();
+		return tree.Size();
+	}, [&]() {
+		loadNaive(&tree, naiveName);
+		return tree.Size();
+	});
+
+	if (shapeChecksum(&tree) != shapeChecksum(&base)) {
+		std::cerr << "load_naive: the loaded tree doesn't match" << std::endl;
+	}
+
+	std::remove(fname.c_str());
+	std::remove(naiveName.c_str());
+}
+
+//rebuilding a million node tree from its journal, from scratch and from the nearest checkpoint
+void benchJournal() {
+	constexpr int seeks = 10;
+
+	NodeTree tree;
+	GrowthJournal journal;
+	GrowthJournal unbroken(SIZE_MAX); //no checkpoints after step 0
+	journal.Start(&tree);
+	growSpacedTree(&tree, 1000000);
+	journal.Stop();
+
+	//the same records, replayed from the start
+	NodeTree base;
+	unbroken.Start(&base);
+	unbroken.AppendRecords(journal);
+	unbroken.Stop();
+
+	NodeTree replayed;
+	measure("journal_replay", benchRuns, 1, [&]() {
+		replayed = NodeTree();
+		return replayed.Size();
+	}, [&]() {
+		unbroken.Replay(&replayed, unbroken.Size());
+		return replayed.Size();
+	});
+
+	if (checksum(&replayed) != checksum(&tree)) {
+		std::cerr << "journal_replay: the replayed tree doesn't match" << std::endl;
+	}
+
+	measure("journal_seek", benchRuns, seeks, [&]() {
+		replayed = NodeTree();
+		return replayed.Size();
+	}, [&]() {
+		long long nodes = 0;
+		for (int i = 1; i <= seeks; i++) {
+			journal.Replay(&replayed, journal.Size() * i / seeks);
+			nodes += replayed.Size();
+		}
+		return nodes;
+	});
+
+	std::cerr << "journal: " << journal.Size() << " records, " << journal.GetCheckpointCount() << " checkpoints" << std::endl;
+}
+
+//the obvious way to move a subtree, for comparison: placing each node in turn from the top
+void moveNaive(NodeTree* tree, NodeIndex root) {
+	forEachNode(tree, root, [tree, root](Node* node) -> int {
+		if (tree->GetIndex(node) != root) {
+			Node* parent = tree->GetNode(node->GetParent());
+			tree->PlaceNode(tree->GetIndex(node), parent->GetOrigin() + directionTable[node->GetDirection()] * node->GetLength());
+		}
+		return Visit::CONTINUE;
+	});
+}
+
+//the exact positions of the nodes, whichever slots they're in
+std::uint64_t originChecksum(NodeTree* tree) {
+	std::uint64_t hash = 0;
+	forEachNode(tree, tree->GetRoot(), [&](Node* node) -> int {
+		Vector2 origin = node->GetOrigin();
+		std::uint64_t x, y;
+		std::memcpy(&x, &origin.x, sizeof(x));
+		std::memcpy(&y, &origin.y, sizeof(y));
+		hash = (hash * 31 + x) * 31 + y;
+		return Visit::CONTINUE;
+	});
+	return hash;
+}
+
+//recomputing the positions of a million node tree: the flat kernel alone, after moving the root, after a few edits, and the obvious way
+void benchTransforms() {
+	constexpr int edits = 1000;
+
+	NodeTree base;
+	growSpacedTree(&base, 1000000);
+
+	//the whole tree in levels, for the kernel on its own
+	TransformPass pass;
+	std::vector<NodeIndex> slots = {base.GetRoot()};
+	pass.AddAnchor(base.GetNode(base.GetRoot())->GetOrigin());
+	for (int begin = 0, end = 1; begin < end; begin = end, end = slots.size()) {
+		pass.NextLevel();
+		for (int slot = begin; slot < end; slot++) {
+			for (NodeIndex child = base.GetNode(slots[slot])->GetFirstChild(); child != NO_NODE; child = base.GetNode(child)->GetNextSibling()) {
+				pass.AddNode(slot, base.GetNode(child)->GetDirection(), base.GetNode(child)->GetLength());
+				slots.push_back(child);
+			}
+		}
+	}
+
+	measure("transform_kernel", benchRuns, 1, [&]() {
+		return base.Size();
+	}, [&]() {
+		pass.Run();
+		return pass.Size() - 1;
+	});
+	double kernelMs = results.back().ms;
+
+	NodeTree tree;
+	int step = 0;
+	measure("transform_move_root", benchRuns, 1, [&]() {
+		tree = base;
+		return tree.Size();
+	}, [&]() {
+		Vector2 root = tree.GetNode(tree.GetRoot())->GetOrigin();
+		tree.PlaceNode(tree.GetRoot(), {root.x + 10 + step++, root.y});
+		return tree.UpdateOrigins();
+	});
+	double moveMs = results.back().ms;
+
+	//edits scattered over the tree, each one stale subtree is usually small
+	std::vector<NodeIndex> targets(edits);
+	BranchRandom rng(benchSeed, edits);
+	for (auto& it : targets) {
+		it = 1 + rng.Next() % (base.Size() - 1);
+	}
+
+	measure("transform_edits", benchRuns, edits, [&]() {
+		tree = base;
+		return tree.Size();
+	}, [&]() {
+		for (auto& it : targets) {
+			tree.SetLength(it, tree.GetNode(it)->GetLength() + 1);
+			tree.SetDirection(it, tree.GetNode(it)->GetDirection() + 5);
+		}
+		return tree.UpdateOrigins();
+	});
+
+	NodeTree naive;
+	measure("transform_naive", 1, 1, [&]() {
+		naive = base;
+		return naive.Size();
+	}, [&]() {
+		Vector2 root = naive.GetNode(naive.GetRoot())->GetOrigin();
+		naive.PlaceNode(naive.GetRoot(), {root.x + 10, root.y});
+		moveNaive(&naive, naive.GetRoot());
+		return naive.Size() - 1;
+	});
+
+	//the same move both ways
+	tree = base;
+	Vector2 root = tree.GetNode(tree.GetRoot())->GetOrigin();
+	tree.PlaceNode(tree.GetRoot(), {root.x + 10, root.y});
+	tree.UpdateOrigins();
+	if (originChecksum(&tree) != originChecksum(&naive)) {
+		std::cerr << "transform_move_root: the positions don't match the obvious way" << std::endl;
+	}
+
+	//and a journaled move replays to the same positions
+	GrowthJournal journal;
+	tree = base;
+	journal.Start(&tree);
+	tree.PlaceNode(tree.GetRoot(), {root.x - 25, root.y + 5});
+	tree.UpdateOrigins();
+	journal.Stop();
+	journal.Replay(&naive, journal.Size());
+	if (originChecksum(&naive) != originChecksum(&tree)) {
+		std::cerr << "transform_move_root: the replayed positions don't match" << std::endl;
+	}
+
+	std::cerr << "transforms: " << std::fixed << std::setprecision(1) << (pass.Size() - 1) / (kernelMs * 1000) << " nodes/us in the kernel, " << (base.Size() - 1) / (moveMs * 1000) << " nodes/us moving the root" << std::endl;
+}
+
+//clicking away at a million node tree
+void benchPruning() {
+	constexpr int clicks = 10000;
+
+	NodeTree base;
+	growSpacedTree(&base, 1000000);
+	std::vector<Vector2> points = pickPoints(&base, clicks);
+	NodeTree tree;
+	long long prunes = 0;
+
+	measure("pruning", benchRuns, clicks, [&]() {
+		tree = NodeTree(base);
+		return tree.Size();
+	}, [&]() {
+		int before = tree.Size();
+		for (auto& it : points) {
+			NodeIndex selected = tree.GetGrid()->FindNearest(it, 8);
+			if (selected != NO_NODE && selected != tree.GetRoot()) {
+				destroyTree(&tree, selected);
+				prunes++;
+			}
+		}
+		return before - tree.Size();
+	});
+}
+
+//growing the example plant from a seedling until it stops, over and over
+void benchGrowToCap() {
+	constexpr int cycles = 100;
+	NodeTree tree;
+	TreeGrower grower;
+
+	measure("grow_to_cap", benchRuns, cycles, [&]() {
+		tree.Clear();
+		return tree.Size();
+	}, [&]() {
+		long long created = 0;
+		for (int i = 0; i < cycles; i++) {
+			tree.Clear();
+			tree.SetSeed(benchSeed + i);
+			int before;
+			do {
+				before = tree.Size();
+				growCherryBlossom(&tree, &grower);
+			} while (tree.Size() != before);
+			created += tree.Size() - 1;
+		}
+		return created;
+	});
+}
+
+//each species from a seedling until it stops, over and over
+template<typename Species>
+void benchSpecies(std::string name) {
+	constexpr int cycles = 100;
+	NodeTree tree;
+	TreeGrower grower;
+
+	measure("species_" + name, benchRuns, cycles, [&]() {
+		tree.Clear();
+		return tree.Size();
+	}, [&]() {
+		long long created = 0;
+		for (int i = 0; i < cycles; i++) {
+			tree.Clear();
+			tree.SetSeed(benchSeed + i);
+			int before;
+			do {
+				before = tree.Size();
+				growSpecies<Species>(&tree, &grower);
+			} while (tree.Size() != before);
+			created += tree.Size() - 1;
+		}
+		return created;
+	});
+}
+
+//-------------------------
+//output
+//-------------------------
+
+void writeJson(std::ostream& os) {
+	os << std::fixed << std::setprecision(3);
+	os << "{" << std::endl;
+	os << "\t\"seed\": " << benchSeed << "," << std::endl;
+	os << "\t\"runs\": " << benchRuns << "," << std::endl;
+	os << "\t\"hardware_threads\": " << std::thread::hardware_concurrency() << "," << std::endl;
+	os << "\t\"peak_memory_kb\": " << peakResidentMemory() << "," << std::endl;
+	os << "\t\"results\": [" << std::endl;
+
+	for (std::size_t i = 0; i < results.size(); i++) {
+		Result& r = results[i];
+		os << "\t\t{";
+		os << "\"name\": \"" << r.name << "\", ";
+		os << "\"tree_nodes\": " << r.treeNodes << ", ";
+		os << "\"ops\": " << r.ops << ", ";
+		os << "\"best_ms\": " << r.ms << ", ";
+		os << "\"ns_per_op\": " << r.ms * 1e6 / r.ops << ", ";
+		if (r.nodes > 0) {
+			os << "\"nodes_per_sec\": " << r.nodes / (r.ms / 1000) << ", ";
+		}
+		else {
+			os << "\"nodes_per_sec\": null, ";
+		}
+		os << "\"allocations\": " << r.allocations << ", ";
+		os << "\"peak_heap_bytes\": " << r.peakHeap;
+		os << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+
+	os << "\t]" << std::endl;
+	os << "}" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	//progress goes to stderr, the results to stdout
+	benchGeneration();
+	benchGrowthScaling();
+	benchTraversal();
+	benchPicking();
+	benchCulling();
+	benchDrawing();
+	benchLSystem();
+	benchTreeFiles();
+	benchJournal();
+	benchTransforms();
+	benchPruning();
+	benchGrowToCap();
+	benchSpecies<CherryBlossom>("cherry_blossom");
+	benchSpecies<Pine>("pine");
+	benchSpecies<Willow>("willow");
+	benchSpecies<Azalea>("azalea");
+
+	writeJson(std::cout);
+	return 0;
+}
@@ -21,11 +21,37 @@
 */
 #include "application.hpp"
 
-#include <chrono>
+#include "texture_loader.hpp"
+
+#include <exception>
+#include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
+
+constexpr std::chrono::duration<int, std::milli> frameDelay(16); //~60FPS
+constexpr std::chrono::microseconds uploadBudget(2000); //texture uploads per frame
 
 void Application::Init(int argc, char* argv[]) {
+	//profiler options
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg.compare(0, 14, "--profile-csv=") == 0) {
+			profileCSV = arg.substr(14);
+		}
+		else if (arg.compare(0, 16, "--profile-trace=") == 0) {
+			profileTrace = arg.substr(16);
+		}
+		else if (arg == "--profile-overlay") {
+			profilerOverlay = true;
+		}
+		else if (arg == "--threaded") {
+			threaded = true;
+		}
+	}
+	profiler.SetRecording(!profileCSV.empty() || !profileTrace.empty());
+	simulationProfiler.SetRecording(profiler.GetRecording());
+
 	//create and check the window
 	window = SDL_CreateWindow(
 		"Example Caption",
@@ -59,15 +85,17 @@ void Application::Init(int argc, char* argv[]) {
 }
 
 void Application::Proc() {
+	if (threaded) {
+		ProcThreaded();
+		return;
+	}
+
 	//load the first scene
 	ProcessSceneSignal(SceneSignal::FIRST);
 
 	//fixed frame rate
-	typedef std::chrono::steady_clock Clock;
-
 	Clock::time_point simTime = Clock::now();
 	Clock::time_point realTime;
-	constexpr std::chrono::duration<int, std::milli> frameDelay(16); //~60FPS
 
 	//the game loop continues until the scenes signal QUIT
 	while(activeScene->GetSceneSignal() != SceneSignal::QUIT) {
@@ -79,15 +107,21 @@ void Application::Proc() {
 
 		//update the current time
 		realTime = Clock::now();
+		profiler.BeginFrame();
 
 		//simulate the game or give the machine a break
 		if (simTime < realTime) {
 			while(simTime < realTime) {
 				//call the user defined functions
+				profiler.CountStep();
 				activeScene->FrameStart();
+				profiler.Lap(FrameProfiler::FRAME_START);
 				ProcessEvents();
+				profiler.Lap(FrameProfiler::PROCESS_EVENTS);
 				activeScene->Update();
+				profiler.Lap(FrameProfiler::UPDATE);
 				activeScene->FrameEnd();
+				profiler.Lap(FrameProfiler::FRAME_END);
 
 				//step to the next frame
 				simTime += frameDelay;
@@ -95,15 +129,160 @@ void Application::Proc() {
 		}
 		else {
 			SDL_Delay(1);
+			profiler.Lap(FrameProfiler::IDLE);
 		}
 
+		//finish off any textures that have been decoded
+		TextureLoader::GetSingleton().UploadPending(renderer, uploadBudget);
+		profiler.Lap(FrameProfiler::UPLOAD);
+
 		SDL_RenderClear(renderer);
 		activeScene->RenderFrame(renderer);
+		if (profilerOverlay) {
+			profiler.DrawOverlay(renderer);
+		}
+		profiler.Lap(FrameProfiler::RENDER_FRAME);
 		SDL_RenderPresent(renderer);
+		profiler.Lap(FrameProfiler::PRESENT);
+		profiler.EndFrame();
+	}
+
+	//cleanup
+	ClearScene();
+	DumpProfile();
+}
+
+void Application::ProcThreaded() {
+	//load the first scene
+	ProcessSceneSignal(SceneSignal::FIRST);
+
+	//each scene gets its own simulation thread, until it signals
+	while(activeScene->GetSceneSignal() != SceneSignal::QUIT) {
+		//switch scenes if necessary
+		if(activeScene->GetSceneSignal() != SceneSignal::CONTINUE) {
+			ProcessSceneSignal(activeScene->GetSceneSignal());
+			continue;
+		}
+
+		//nothing from the last scene carries over
+		std::vector<SDL_Event> stale;
+		events.Drain(&stale);
+		TripleBuffer<RenderSnapshot> snapshots;
+
+		//either thread clears this to stop the other
+		std::atomic<bool> running(true);
+		std::exception_ptr failure;
+		std::thread simulation([&]() {
+			try {
+				SimulationLoop(&snapshots, &running);
+			}
+			catch(...) {
+				failure = std::current_exception();
+			}
+			running = false;
+		});
+
+		try {
+			RenderLoop(&snapshots, &running);
+		}
+		catch(...) {
+			running = false;
+			simulation.join();
+			throw;
+		}
+
+		simulation.join();
+		if (failure) {
+			std::rethrow_exception(failure);
+		}
 	}
 
 	//cleanup
 	ClearScene();
+	DumpProfile();
+}
+
+void Application::RenderLoop(TripleBuffer<RenderSnapshot>* snapshots, std::atomic<bool>* running) {
+	//never waits on the simulation
+	while(*running) {
+		profiler.BeginFrame();
+
+		//SDL wants its events pumped on the main thread
+		SDL_Event event;
+		while(SDL_PollEvent(&event)) {
+			if (!ProcessInternalEvent(event)) {
+				events.Push(event);
+			}
+		}
+		profiler.Lap(FrameProfiler::PROCESS_EVENTS);
+
+		//draw the latest snapshot, or give the machine a break
+		bool fresh = snapshots->Acquire();
+		if (!fresh) {
+			SDL_Delay(1);
+			profiler.Lap(FrameProfiler::IDLE);
+		}
+
+		TextureLoader::GetSingleton().UploadPending(renderer, uploadBudget);
+		profiler.Lap(FrameProfiler::UPLOAD);
+
+		SDL_RenderClear(renderer);
+		activeScene->DrawSnapshot(renderer, snapshots->GetFront(), fresh);
+		if (profilerOverlay) {
+			profiler.DrawOverlay(renderer);
+		}
+		profiler.Lap(FrameProfiler::RENDER_FRAME);
+		SDL_RenderPresent(renderer);
+		profiler.Lap(FrameProfiler::PRESENT);
+		profiler.EndFrame();
+	}
+}
+
+void Application::SimulationLoop(TripleBuffer<RenderSnapshot>* snapshots, std::atomic<bool>* running) {
+	//fixed frame rate
+	Clock::time_point simTime = Clock::now();
+	Clock::time_point realTime;
+	std::vector<SDL_Event> pending;
+
+	while(*running && activeScene->GetSceneSignal() == SceneSignal::CONTINUE) {
+		//update the current time
+		realTime = Clock::now();
+		simulationProfiler.BeginFrame();
+
+		//simulate the game or give the machine a break
+		if (simTime < realTime) {
+			while(simTime < realTime) {
+				//call the user defined functions
+				simulationProfiler.CountStep();
+				activeScene->FrameStart();
+				simulationProfiler.Lap(FrameProfiler::FRAME_START);
+				events.Drain(&pending);
+				for (auto& it : pending) {
+					DispatchEvent(it);
+				}
+				simulationProfiler.Lap(FrameProfiler::PROCESS_EVENTS);
+				activeScene->Update();
+				simulationProfiler.Lap(FrameProfiler::UPDATE);
+				activeScene->FrameEnd();
+				simulationProfiler.Lap(FrameProfiler::FRAME_END);
+
+				//step to the next frame
+				simTime += frameDelay;
+			}
+
+			//hand the results to the render thread
+			if (activeScene->WriteSnapshot(snapshots->GetBack())) {
+				snapshots->Publish();
+			}
+			simulationProfiler.Lap(FrameProfiler::SNAPSHOT);
+		}
+		else {
+			SDL_Delay(1);
+			simulationProfiler.Lap(FrameProfiler::IDLE);
+		}
+
+		simulationProfiler.EndFrame();
+	}
 }
 
 void Application::Quit() {
@@ -120,49 +299,91 @@ void Application::Quit() {
 void Application::ProcessEvents() {
 	SDL_Event event;
 	while(SDL_PollEvent(&event)) {
-		switch(event.type) {
-			case SDL_QUIT:
-				activeScene->QuitEvent();
-			break;
-
-			case SDL_MOUSEMOTION:
-				activeScene->MouseMotion(event.motion);
-			break;
-
-			case SDL_MOUSEBUTTONDOWN:
-				activeScene->MouseButtonDown(event.button);
-			break;
-
-			case SDL_MOUSEBUTTONUP:
-				activeScene->MouseButtonUp(event.button);
-			break;
-
-			case SDL_MOUSEWHEEL:
-				activeScene->MouseWheel(event.wheel);
-			break;
-
-			case SDL_KEYDOWN:
-				activeScene->KeyDown(event.key);
-			break;
-
-			case SDL_KEYUP:
-				activeScene->KeyUp(event.key);
-			break;
-
-			//TODO: joystick and controller events
-
-			//window events are handled internally
-			case SDL_WINDOWEVENT:
-				switch(event.window.event) {
-					case SDL_WINDOWEVENT_RESIZED:
-						SDL_RenderSetLogicalSize(renderer, event.window.data1, event.window.data2);
-					break;
-				}
-			break;
+		if (!ProcessInternalEvent(event)) {
+			DispatchEvent(event);
 		}
 	}
 }
 
+bool Application::ProcessInternalEvent(SDL_Event const& event) {
+	switch(event.type) {
+		//window events are handled internally, then passed on
+		case SDL_WINDOWEVENT:
+			switch(event.window.event) {
+				case SDL_WINDOWEVENT_RESIZED:
+					SDL_RenderSetLogicalSize(renderer, event.window.data1, event.window.data2);
+				break;
+			}
+		break;
+
+		//so is the profiler overlay
+		case SDL_KEYDOWN:
+			if (event.key.keysym.sym == SDLK_F3) {
+				profilerOverlay = !profilerOverlay;
+				return true;
+			}
+		break;
+	}
+	return false;
+}
+
+void Application::DispatchEvent(SDL_Event const& event) {
+	switch(event.type) {
+		case SDL_QUIT:
+			activeScene->QuitEvent();
+		break;
+
+		case SDL_MOUSEMOTION:
+			activeScene->MouseMotion(event.motion);
+		break;
+
+		case SDL_MOUSEBUTTONDOWN:
+			activeScene->MouseButtonDown(event.button);
+		break;
+
+		case SDL_MOUSEBUTTONUP:
+			activeScene->MouseButtonUp(event.button);
+		break;
+
+		case SDL_MOUSEWHEEL:
+			activeScene->MouseWheel(event.wheel);
+		break;
+
+		case SDL_KEYDOWN:
+			activeScene->KeyDown(event.key);
+		break;
+
+		case SDL_KEYUP:
+			activeScene->KeyUp(event.key);
+		break;
+
+		case SDL_WINDOWEVENT:
+			if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+				activeScene->WindowResized(event.window.data1, event.window.data2);
+			}
+		break;
+
+		//TODO: joystick and controller events
+	}
+}
+
+void Application::DumpProfile() {
+	std::vector<FrameProfiler*> profilers = {&profiler};
+	if (threaded) {
+		profilers.push_back(&simulationProfiler);
+	}
+
+	for (auto& it : profilers) {
+		it->WriteSummary(std::cout);
+	}
+	if (!profileCSV.empty()) {
+		FrameProfiler::WriteCSV(profileCSV, profilers);
+	}
+	if (!profileTrace.empty()) {
+		FrameProfiler::WriteTrace(profileTrace, profilers);
+	}
+}
+
 //Add the custom scene headers here
 #include "example_scene.hpp"
 
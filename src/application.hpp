@@ -22,15 +22,26 @@
 #pragma once
 
 #include "base_scene.hpp"
+#include "event_queue.hpp"
+#include "frame_profiler.hpp"
+#include "render_snapshot.hpp"
 #include "scene_signal.hpp"
+#include "triple_buffer.hpp"
 
 #include "SDL2/SDL.h"
 
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
 //TODO: do something with these
 constexpr int screenWidth = 800;
 constexpr int screenHeight = 600;
 
 //DOCS: The Application class handles scene switching, utilizing only one window
+//DOCS: With --threaded, the scene simulates on its own thread and publishes RenderSnapshots
+//DOCS: while the main thread pumps SDL events into a queue and draws the latest snapshot
 class Application {
 public:
 	Application() = default;
@@ -41,12 +52,31 @@ public:
 	void Quit();
 
 private:
+	typedef std::chrono::steady_clock Clock;
+
+	//threaded mode
+	void ProcThreaded();
+	void RenderLoop(TripleBuffer<RenderSnapshot>* snapshots, std::atomic<bool>* running);
+	void SimulationLoop(TripleBuffer<RenderSnapshot>* snapshots, std::atomic<bool>* running);
+
 	//scene management
 	void ProcessEvents();
+	bool ProcessInternalEvent(SDL_Event const& event);
+	void DispatchEvent(SDL_Event const& event);
 	void ProcessSceneSignal(SceneSignal);
 	void ClearScene();
+	void DumpProfile();
 
 	BaseScene* activeScene = nullptr;
+	bool threaded = false;
+	EventQueue events;
+
+	//F3 toggles the overlay, --profile-csv=file and --profile-trace=file record every frame
+	FrameProfiler profiler;
+	FrameProfiler simulationProfiler{"Simulation"};
+	bool profilerOverlay = false;
+	std::string profileCSV;
+	std::string profileTrace;
 
 	//TODO: build a "window" class?
 	SDL_Window* window = nullptr;
@@ -0,0 +1,82 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "atlas_packer.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<AtlasPacker::Placement> AtlasPacker::Pack(std::vector<std::pair<int, int>> const& sizes) {
+	std::vector<Placement> placements(sizes.size());
+	pageHeights.clear();
+
+	//tallest first keeps the shelves tight
+	std::vector<int> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sizes](int lhs, int rhs) {
+		return sizes[lhs].second > sizes[rhs].second || (sizes[lhs].second == sizes[rhs].second && sizes[lhs].first > sizes[rhs].first);
+	});
+
+	int x = 0, shelfY = 0, shelfHeight = 0;
+	for (int i : order) {
+		int w = sizes[i].first;
+		int h = sizes[i].second;
+		if (w > pageSize || h > pageSize) {
+			std::ostringstream msg;
+			msg << "An image of " << w << "x" << h << " is too large for an atlas page of " << pageSize;
+			throw(std::runtime_error(msg.str()));
+		}
+
+		//start a new shelf, then a new page
+		if (x + w > pageSize) {
+			shelfY += shelfHeight;
+			x = 0;
+			shelfHeight = 0;
+		}
+		if (pageHeights.empty() || shelfY + h > pageSize) {
+			pageHeights.push_back(0);
+			x = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+
+		placements[i] = {int(pageHeights.size()) - 1, x, shelfY};
+		x += w;
+		shelfHeight = std::max(shelfHeight, h);
+		pageHeights.back() = std::max(pageHeights.back(), shelfY + h);
+	}
+
+	return placements;
+}
+
+int AtlasPacker::GetPageSize() {
+	return pageSize;
+}
+
+int AtlasPacker::GetPageCount() {
+	return pageHeights.size();
+}
+
+int AtlasPacker::GetPageHeight(int page) {
+	return pageHeights[page];
+}
@@ -0,0 +1,49 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include <utility>
+#include <vector>
+
+//DOCS: AtlasPacker places rectangles onto square pages, in shelves from the tallest down
+//DOCS: It only does the arithmetic, TextureLoader moves the pixels
+class AtlasPacker {
+public:
+	struct Placement {
+		int page;
+		int x, y;
+	};
+
+	AtlasPacker(int size): pageSize(size) {};
+	~AtlasPacker() = default;
+
+	//the placements are in the same order as the sizes, (width, height) pairs
+	std::vector<Placement> Pack(std::vector<std::pair<int, int>> const& sizes);
+
+	int GetPageSize();
+	int GetPageCount();
+	int GetPageHeight(int page); //how much of the page is used
+
+private:
+	int pageSize;
+	std::vector<int> pageHeights;
+};
@@ -67,6 +67,14 @@ void BaseScene::FrameEnd() {
 	//EMPTY
 }
 
+bool BaseScene::WriteSnapshot(RenderSnapshot* snapshot) {
+	return false;
+}
+
+void BaseScene::DrawSnapshot(SDL_Renderer* renderer, RenderSnapshot* snapshot, bool fresh) {
+	//EMPTY
+}
+
 //-------------------------
 //input events
 //-------------------------
@@ -103,3 +111,7 @@ void BaseScene::KeyDown(SDL_KeyboardEvent const& event) {
 void BaseScene::KeyUp(SDL_KeyboardEvent const& event) {
 	//EMPTY
 }
+
+void BaseScene::WindowResized(int w, int h) {
+	//EMPTY
+}
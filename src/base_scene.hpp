@@ -21,10 +21,13 @@
 */
 #pragma once
 
+#include "render_snapshot.hpp"
 #include "scene_signal.hpp"
 
 #include "SDL2/SDL.h"
 
+#include <atomic>
+
 class BaseScene {
 public:
 	BaseScene();
@@ -39,6 +42,11 @@ public:
 	virtual void Update();
 	virtual void FrameEnd();
 
+	//threaded mode, the simulation thread writes snapshots and the render thread draws them
+	//WriteSnapshot() returns false when nothing changed since the last one
+	virtual bool WriteSnapshot(RenderSnapshot* snapshot);
+	virtual void DrawSnapshot(SDL_Renderer* renderer, RenderSnapshot* snapshot, bool fresh);
+
 	//input events
 	virtual void QuitEvent();
 	virtual void MouseMotion(SDL_MouseMotionEvent const& event);
@@ -47,6 +55,7 @@ public:
 	virtual void MouseWheel(SDL_MouseWheelEvent const& event);
 	virtual void KeyDown(SDL_KeyboardEvent const& event);
 	virtual void KeyUp(SDL_KeyboardEvent const& event);
+	virtual void WindowResized(int w, int h);
 
 	//TODO: joystick and controller events
 
@@ -57,5 +66,5 @@ protected:
 
 private:
 	static SDL_Renderer* rendererHandle;
-	SceneSignal sceneSignal = SceneSignal::CONTINUE;
+	std::atomic<SceneSignal> sceneSignal{SceneSignal::CONTINUE};
 };
\ No newline at end of file
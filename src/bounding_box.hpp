@@ -0,0 +1,72 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "vector2.hpp"
+
+#include <limits>
+#include <type_traits>
+
+//DOCS: BoundingBox is an axis aligned box, it starts empty and grows to fit what's added
+class BoundingBox {
+public:
+	double minX, minY, maxX, maxY;
+
+	BoundingBox() = default;
+	BoundingBox(double x1, double y1, double x2, double y2): minX(x1), minY(y1), maxX(x2), maxY(y2) {};
+	~BoundingBox() = default;
+
+	static BoundingBox Nothing() {
+		constexpr double inf = std::numeric_limits<double>::infinity();
+		return {inf, inf, -inf, -inf};
+	}
+
+	bool Empty() const {
+		return minX > maxX || minY > maxY;
+	}
+
+	void Expand(Vector2 v) {
+		minX = v.x < minX ? v.x : minX;
+		minY = v.y < minY ? v.y : minY;
+		maxX = v.x > maxX ? v.x : maxX;
+		maxY = v.y > maxY ? v.y : maxY;
+	}
+	void Expand(BoundingBox const& b) {
+		minX = b.minX < minX ? b.minX : minX;
+		minY = b.minY < minY ? b.minY : minY;
+		maxX = b.maxX > maxX ? b.maxX : maxX;
+		maxY = b.maxY > maxY ? b.maxY : maxY;
+	}
+
+	bool Intersects(BoundingBox const& b) const {
+		return minX <= b.maxX && b.minX <= maxX && minY <= b.maxY && b.minY <= maxY;
+	}
+	bool Contains(Vector2 v) const {
+		return minX <= v.x && v.x <= maxX && minY <= v.y && v.y <= maxY;
+	}
+	bool Contains(BoundingBox const& b) const {
+		return b.Empty() || (minX <= b.minX && b.maxX <= maxX && minY <= b.minY && b.maxY <= maxY);
+	}
+};
+
+//This is explicitly a POD
+static_assert(std::is_pod<BoundingBox>::value, "BoundingBox is not a POD");
@@ -0,0 +1,69 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include <cstdint>
+
+//DOCS: BranchRandom is a counter-based generator (SplitMix64), each (seed, key, salt) triple is an independent stream
+//DOCS: Streams never share state, so branches can draw in any order, or on any thread, and get the same numbers
+class BranchRandom {
+public:
+	BranchRandom(std::uint64_t seed, std::uint64_t key, std::uint64_t salt = 0) {
+		stream = Mix(seed ^ Mix(key ^ Mix(salt + golden)));
+	}
+	~BranchRandom() = default;
+
+	std::uint32_t Next() {
+		return std::uint32_t(Mix(stream + ++counter * golden) >> 32);
+	}
+
+	//draw a batch of numbers at once
+	void Fill(std::uint32_t* out, int count) {
+		for (int i = 0; i < count; i++) {
+			out[i] = std::uint32_t(Mix(stream + (counter + i + 1) * golden) >> 32);
+		}
+		counter += count;
+	}
+
+	//identity of the ordinal-th child ever created under a node
+	static std::uint64_t ChildKey(std::uint64_t parentKey, int ordinal) {
+		return Mix(parentKey + (std::uint64_t(ordinal) + 1) * golden);
+	}
+
+	//the same node's key for another kind of draw, so its streams can't overlap the node's own
+	static std::uint64_t TagKey(std::uint64_t key, std::uint64_t tag) {
+		return Mix(key ^ Mix(tag * golden));
+	}
+
+	//the SplitMix64 finalizer
+	static std::uint64_t Mix(std::uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+private:
+	static constexpr std::uint64_t golden = 0x9E3779B97F4A7C15ull;
+
+	std::uint64_t stream;
+	std::uint64_t counter = 0;
+};
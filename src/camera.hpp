@@ -0,0 +1,90 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "bounding_box.hpp"
+#include "vector2.hpp"
+
+//DOCS: Camera maps the world onto the screen, panning and zooming over a viewport of a fixed size
+class Camera {
+public:
+	Camera() = default;
+	Camera(int w, int h): viewWidth(w), viewHeight(h) {};
+	~Camera() = default;
+
+	Vector2 WorldToScreen(Vector2 v) const {
+		return (v - position) * zoom;
+	}
+	Vector2 ScreenToWorld(Vector2 v) const {
+		return v / zoom + position;
+	}
+
+	//in screen pixels
+	void Pan(double dx, double dy) {
+		position.x -= dx / zoom;
+		position.y -= dy / zoom;
+	}
+
+	//keeps the world point under the screen point in place
+	void ZoomAbout(Vector2 screenPoint, double factor) {
+		Vector2 anchor = ScreenToWorld(screenPoint);
+		zoom = ClampZoom(zoom * factor);
+		position = anchor - screenPoint / zoom;
+	}
+
+	//the visible part of the world
+	BoundingBox GetView() const {
+		Vector2 corner = ScreenToWorld({double(viewWidth), double(viewHeight)});
+		return {position.x, position.y, corner.x, corner.y};
+	}
+
+	void SetViewport(int w, int h) {
+		viewWidth = w;
+		viewHeight = h;
+	}
+
+	Vector2 SetPosition(Vector2 v) {
+		return position = v;
+	}
+	Vector2 GetPosition() const {
+		return position;
+	}
+	double SetZoom(double z) {
+		return zoom = ClampZoom(z);
+	}
+	double GetZoom() const {
+		return zoom;
+	}
+
+	static constexpr double minZoom = 1.0 / 64;
+	static constexpr double maxZoom = 16;
+
+private:
+	static double ClampZoom(double z) {
+		return z < minZoom ? minZoom : z > maxZoom ? maxZoom : z;
+	}
+
+	Vector2 position = {0, 0}; //the world point at the top left of the screen
+	double zoom = 1;
+	int viewWidth = 0;
+	int viewHeight = 0;
+};
@@ -0,0 +1,87 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "vector2.hpp"
+
+//DOCS: DirectionTable holds the unit vector of every whole-degree heading, built at compile time
+//right = 0, down = 90, left = 180, up = 270
+class DirectionTable {
+public:
+	constexpr DirectionTable(): x(), y() {
+		for (int i = 0; i < 360; i++) {
+			x[i] = Sine(i + 90);
+			y[i] = Sine(i);
+		}
+	}
+
+	//any heading, including negative ones
+	Vector2 operator[](int direction) const {
+		int i = direction % 360;
+		if (i < 0) {
+			i += 360;
+		}
+		return {x[i], y[i]};
+	}
+
+	double x[360];
+	double y[360];
+
+private:
+	//exact at the quadrant boundaries, a Taylor series within 45 degrees of them
+	static constexpr double Sine(int degrees) {
+		int d = degrees % 360;
+		double sign = 1;
+		if (d >= 180) {
+			d -= 180;
+			sign = -1;
+		}
+		if (d > 90) {
+			d = 180 - d;
+		}
+		return d <= 45 ? sign * TaylorSine(d * pi / 180.0) : sign * TaylorCosine((90 - d) * pi / 180.0);
+	}
+
+	static constexpr double TaylorSine(double r) {
+		double term = r;
+		double sum = r;
+		for (int n = 1; n < 12; n++) {
+			term *= -r * r / ((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	static constexpr double TaylorCosine(double r) {
+		double term = 1;
+		double sum = 1;
+		for (int n = 1; n < 12; n++) {
+			term *= -r * r / ((2 * n - 1) * (2 * n));
+			sum += term;
+		}
+		return sum;
+	}
+
+	static constexpr double pi = 3.14159265358979323846;
+};
+
+constexpr DirectionTable directionTable;
@@ -21,115 +21,50 @@
 */
 #include "example_scene.hpp"
 
-//-------------------------
-//tree management
-//-------------------------
-
-//auto-grow the tree, (customize for different species)
-void growCherryBlossom(Node* root) {
-	//defaults
-	int depth = 0;
-	int spread = 50;
-	int sproutChance = 10;
-
-	//maximum plant size
-	std::list<Node*> leafList;
-	findLeaves(root, &leafList);
-
-//	if (findDeepestLeaf(root) >= 60) {
-	if (leafList.size() >= 800) {
-		return;
-	}
-
-	//set all non-flowers to stems
-	forEachNode(root, [](Node* node) -> int {
-		if (node->GetType() != Node::Type::FLOWER) {
-			node->SetType(Node::Type::STEM);
-			return 0;
-		}
-		return 0;
-	});
-
-	//shape the trunk
-	int deepestLeaf = findDeepestLeaf(root);
-	if (deepestLeaf < 6) {
-		spread = 20;
-		sproutChance = 99;
-	}
-	if (deepestLeaf == 6) {
-		sproutChance = 0;
-	}
-
-	//grow all non-flower leaves
-	for (auto& it : leafList) {
-		if (it->GetType() != Node::Type::FLOWER) {
-			generateTree(it, depth, spread, sproutChance);
-		}
-	}
-
-	//grow some flowers
-	for (auto& it : leafList) {
-		//trunk
-		if (deepestLeaf < 10) {
-			break;
-		}
-
-		if (it->GetType() == Node::Type::FLOWER) {
-			continue;
-		}
-
-		if (rand() % 10 == 0) {
-			Node* child = addChildNode(it, rand() % (spread*2) + it->GetDirection() - spread, it->GetLength());
-			child->SetType(Node::Type::FLOWER);
-		}
-	}
-
-	//re-mark all non-flower leaves
-	leafList.clear();
-	findLeaves(root, &leafList);
-	for (auto& it : leafList) {
-		if (it->GetType() != Node::Type::FLOWER) {
-			it->SetType(Node::Type::LEAF);
-		}
-	}
-}
-
 //-------------------------
 //Scene
 //-------------------------
 
 ExampleScene::ExampleScene() {
 	//setup
-	srand(time(nullptr));
-	textureLoader.Load(GetRenderer(), "rsc/", "pot.png");
-	textureLoader.Load(GetRenderer(), "rsc/", "stem.png");
-	textureLoader.Load(GetRenderer(), "rsc/", "leaf.png");
-	textureLoader.Load(GetRenderer(), "rsc/", "flower.png");
-
-	//setup the rootload
-	rootNode = new Node();
-	rootNode->GetSprite()->SetTexture(textureLoader.Find("stem.png"));
-	rootNode->SetOrigin({400, 500});
+	tree.SetSeed(time(nullptr));
+	std::cout << "Seed: " << tree.GetSeed() << std::endl;
+	textureLoader.LoadAtlas(GetRenderer(), "rsc/", {"pot.png", "stem.png", "leaf.png", "flower.png"});
+	typeSprites[Node::Type::LEAF] = textureLoader.FindHandle("leaf.png");
+	typeSprites[Node::Type::STEM] = textureLoader.FindHandle("stem.png");
+	typeSprites[Node::Type::FLOWER] = textureLoader.FindHandle("flower.png");
+
+	//setup the root node
+	Node* rootNode = tree.GetNode(tree.GetRoot());
+	tree.PlaceNode(tree.GetRoot(), {400, 500});
 	rootNode->SetDirection(270);
+	journal.Start(&tree);
 
 	//put the pot under the plant
-	potImage.SetTexture(textureLoader.Find("pot.png"));
-	potX = rootNode->GetOrigin().x - potImage.GetClipW() / 2;
-	potY = rootNode->GetOrigin().y;
-
-	std::list<Node*> leafList;
+	potSprite = textureLoader.FindHandle("pot.png");
 
-	findLeaves(rootNode, &leafList);
+	std::cout << "Leaves: " << tree.GetLeafCount() << std::endl;
+	CorrectSprites();
 
-	std::cout << "Leaves: " << leafList.size() << std::endl;
+	//how far past a node's origin its sprite can reach
+	for (auto& it : typeSprites) {
+		Image* sprite = textureLoader.GetImage(it);
+		spritePadding = std::max<int>(spritePadding, std::max(sprite->GetClipW(), sprite->GetClipH()));
+	}
 
-	for (auto& it : leafList) {
-		it->GetSprite()->SetTexture(textureLoader.Find("leaf.png"));
+	//the camera starts out showing the logical screen
+	int w = 0, h = 0;
+	SDL_RenderGetLogicalSize(GetRenderer(), &w, &h);
+	if (w == 0 || h == 0) {
+		SDL_GetRendererOutputSize(GetRenderer(), &w, &h);
 	}
+	camera.SetViewport(w, h);
+
+	impostors.Create(GetRenderer());
 }
 
 ExampleScene::~ExampleScene() {
-	destroyTree(rootNode);
+	//EMPTY
 }
 
 //-------------------------
@@ -149,8 +84,68 @@ void ExampleScene::FrameEnd() {
 }
 
 void ExampleScene::RenderFrame(SDL_Renderer* renderer) {
-	drawNodeTree(renderer, rootNode);
-	potImage.DrawTo(renderer, potX, potY);
+	//only redraw around the nodes that changed
+	BoundingBox dirty = tree.GetDirtyBounds();
+	if (redrawAll) {
+		renderCache.Invalidate();
+		tree.ClearDirtyBounds();
+		redrawAll = false;
+	}
+	else if (!dirty.Empty()) {
+		Vector2 topLeft = camera.WorldToScreen({dirty.minX - spritePadding, dirty.minY - spritePadding});
+		Vector2 bottomRight = camera.WorldToScreen({dirty.maxX + spritePadding, dirty.maxY + spritePadding});
+		SDL_Rect region;
+		region.x = int(std::floor(topLeft.x));
+		region.y = int(std::floor(topLeft.y));
+		region.w = int(std::ceil(bottomRight.x - topLeft.x)) + 1;
+		region.h = int(std::ceil(bottomRight.y - topLeft.y)) + 1;
+		renderCache.Invalidate(region);
+		tree.ClearDirtyBounds();
+	}
+
+	renderCache.DrawTo(renderer, [this](SDL_Renderer* renderer) {
+		impostors.NextFrame();
+		DrawScene(&spriteBatch, &impostors);
+		spriteBatch.Flush(renderer);
+	});
+}
+
+bool ExampleScene::WriteSnapshot(RenderSnapshot* snapshot) {
+	//nothing to publish
+	if (!redrawAll && tree.GetDirtyBounds().Empty()) {
+		return false;
+	}
+	redrawAll = false;
+	tree.ClearDirtyBounds();
+
+	//only handles & positions, this thread can't touch the textures, (or render impostors)
+	snapshot->sprites.clear();
+	snapshot->zoom = camera.GetZoom();
+	snapshotNodeTree(snapshot, &tree, tree.GetRoot(), camera, spritePadding);
+
+	Vector2 pot = camera.WorldToScreen(tree.GetNode(tree.GetRoot())->GetOrigin());
+	snapshot->sprites.push_back({potSprite, float(pot.x), float(pot.y)});
+	return true;
+}
+
+void ExampleScene::DrawSnapshot(SDL_Renderer* renderer, RenderSnapshot* snapshot, bool fresh) {
+	//snapshots can be skipped, so a new one is redrawn in full
+	if (fresh) {
+		snapshotCache.Invalidate();
+	}
+
+	snapshotCache.DrawTo(renderer, [this, snapshot](SDL_Renderer* renderer) {
+		//the handles become textures here, on the render thread
+		float zoom = snapshot->zoom;
+		for (auto& it : snapshot->sprites) {
+			Image* sprite = textureLoader.GetImage(it.handle);
+			if (!sprite) {
+				continue;
+			}
+			snapshotBatch.Draw(sprite->GetTexture(), sprite->GetClip(), it.x - sprite->GetClipW() / 2 * zoom, it.y, sprite->GetClipW() * zoom, sprite->GetClipH() * zoom);
+		}
+		snapshotBatch.Flush(renderer);
+	});
 }
 
 //-------------------------
@@ -158,37 +153,28 @@ void ExampleScene::RenderFrame(SDL_Renderer* renderer) {
 //-------------------------
 
 void ExampleScene::MouseMotion(SDL_MouseMotionEvent const& event) {
-	//
+	mouse = Vector2(event.x, event.y);
+
+	//drag with the right or middle button to pan
+	if (event.state & (SDL_BUTTON_RMASK | SDL_BUTTON_MMASK)) {
+		camera.Pan(event.xrel, event.yrel);
+		redrawAll = true;
+	}
 }
 
 void ExampleScene::MouseButtonDown(SDL_MouseButtonEvent const& event) {
 	switch(event.button) {
 		case SDL_BUTTON_LEFT: {
 			//find the selected node
-			Node* selected = nullptr;
-			Vector2 mouse(event.x, event.y);
-			forEachNode(rootNode, [&](Node* node) -> int {
-				if ((mouse - node->GetOrigin()).Length() <= 8) {
-					selected = node;
-				}
-				return 0;
-			});
-
-			//delete the selected node & it's children
-			if (selected != nullptr && selected != rootNode) {
-				destroyTree(selected);
+			Vector2 world = camera.ScreenToWorld(Vector2(event.x, event.y));
+			NodeIndex selected = tree.GetGrid()->FindNearest(world, 8 / camera.GetZoom());
+
+			if (selected == NO_NODE || selected == tree.GetRoot()) {
+				break;
 			}
 
-			//BUGFIX: find and fix the invalidated pointer
-			forEachNode(rootNode, [&](Node* node) -> int {
-				for (std::list<Node*>::iterator it = node->GetChildren()->begin(); it != node->GetChildren()->end(); it++) {
-					if (*it == selected) {
-						node->GetChildren()->erase(it);
-						return 0;
-					}
-				}
-				return 0;
-			});
+			//detach and delete the selected node & its children
+			destroyTree(&tree, selected);
 		}
 		break;
 	}
@@ -199,7 +185,9 @@ void ExampleScene::MouseButtonUp(SDL_MouseButtonEvent const& event) {
 }
 
 void ExampleScene::MouseWheel(SDL_MouseWheelEvent const& event) {
-	//
+	//zoom in or out about the cursor
+	camera.ZoomAbout(mouse, std::pow(1.1, event.y));
+	redrawAll = true;
 }
 
 void ExampleScene::KeyDown(SDL_KeyboardEvent const& event) {
@@ -210,42 +198,111 @@ void ExampleScene::KeyDown(SDL_KeyboardEvent const& event) {
 		break;
 
 		case SDLK_SPACE: {
-			growCherryBlossom(rootNode);
-			std::list<Node*> leafList;
-			findLeaves(rootNode, &leafList);
-			std::cout << "Leaves: " << leafList.size() << "\tTotal Nodes: " << countEachNode(rootNode) << std::endl;
+			growPlant(&tree, &grower);
+			std::cout << "Leaves: " << tree.GetLeafCount() << "\tTotal Nodes: " << tree.Size() << "\tHeight: " << findDeepestLeaf(&tree, tree.GetRoot());
+			std::cout << "\tSlot Allocations: " << tree.GetSlotAllocations() << "\tHeap Allocations: " << tree.GetHeapAllocations();
+			std::cout << "\tDraw Calls: " << spriteBatch.GetDrawCalls() << "\tVertices: " << spriteBatch.GetVertexCount() << "\tImpostors: " << impostors.GetDrawCount();
+			std::cout << "\tJournal: " << journal.Size() << std::endl;
 			CorrectSprites();
 		}
 		break;
 
 		case SDLK_TAB:
-			for (auto& it : *rootNode->GetChildren()) {
-				destroyTree(it);
+			ClearPlant();
+		break;
+
+		//start over with another species
+		case SDLK_1:
+		case SDLK_2:
+		case SDLK_3:
+		case SDLK_4: {
+			void (*species[])(NodeTree*, TreeGrower*) = {growSpecies<CherryBlossom>, growSpecies<Pine>, growSpecies<Willow>, growSpecies<Azalea>};
+			growPlant = species[event.keysym.sym - SDLK_1];
+			ClearPlant();
+		}
+		break;
+
+		//replace the plant with an L-system bush
+		case SDLK_l:
+			generateLSystemBush(&tree, 14, tree.GetSeed());
+			std::cout << "Leaves: " << tree.GetLeafCount() << "\tTotal Nodes: " << tree.Size() << std::endl;
+			CorrectSprites();
+			redrawAll = true;
+		break;
+
+		case SDLK_F5:
+			saveTree(&tree, "bonsai.tree");
+			std::cout << "Saved " << tree.Size() << " nodes" << std::endl;
+		break;
+
+		case SDLK_F9:
+			try {
+				loadTree(&tree, "bonsai.tree");
+				std::cout << "Loaded " << tree.Size() << " nodes, Seed: " << tree.GetSeed() << std::endl;
+			}
+			catch(std::exception& e) {
+				std::cerr << "Couldn't load the tree: " << e.what() << std::endl;
 			}
-			rootNode->GetChildren()->clear();
 			CorrectSprites();
+			redrawAll = true;
+		break;
+
+		//move the whole plant, pot and all
+		case SDLK_LEFT:
+		case SDLK_RIGHT: {
+			Vector2 root = tree.GetNode(tree.GetRoot())->GetOrigin();
+			root.x += event.keysym.sym == SDLK_LEFT ? -10 : 10;
+			tree.PlaceNode(tree.GetRoot(), root);
+			std::cout << "Moved: " << tree.UpdateOrigins() << " nodes" << std::endl;
+			redrawAll = true;
+		}
+		break;
+
+		case SDLK_HOME:
+			camera.SetPosition({0, 0});
+			camera.SetZoom(1);
+			redrawAll = true;
+		break;
 	}
 }
 
+void ExampleScene::WindowResized(int w, int h) {
+	camera.SetViewport(w, h);
+	redrawAll = true;
+}
+
 void ExampleScene::KeyUp(SDL_KeyboardEvent const& event) {
 	//
 }
 
+//everything visible, in screen coordinates
+void ExampleScene::DrawScene(SpriteBatch* batch, ImpostorCache* cache) {
+	drawNodeTree(batch, &tree, tree.GetRoot(), camera, spritePadding, cache);
+
+	Image* pot = textureLoader.GetImage(potSprite);
+	Vector2 root = tree.GetNode(tree.GetRoot())->GetOrigin();
+	Vector2 draw = camera.WorldToScreen({root.x - pot->GetClipW() / 2, root.y});
+	batch->Draw(pot->GetTexture(), pot->GetClip(), draw.x, draw.y, pot->GetClipW() * camera.GetZoom(), pot->GetClipH() * camera.GetZoom());
+}
+
+//back to a seedling in the pot
+void ExampleScene::ClearPlant() {
+	tree.Clear();
+	CorrectSprites();
+	redrawAll = true;
+}
+
+//only the nodes created or retyped since the last call
 void ExampleScene::CorrectSprites() {
-	forEachNode(rootNode, [&](Node* node) -> int {
-		switch(node->GetType()) {
-			case Node::Type::LEAF:
-				node->GetSprite()->SetTexture(textureLoader.Find("leaf.png"));
-			break;
-
-			case Node::Type::STEM:
-				node->GetSprite()->SetTexture(textureLoader.Find("stem.png"));
-			break;
-
-			case Node::Type::FLOWER:
-				node->GetSprite()->SetTexture(textureLoader.Find("flower.png"));
-			break;
+	for (auto& it : tree.GetTypeChanges()) {
+		Node* node = tree.GetNode(it);
+		TextureHandle sprite = typeSprites[node->GetType()];
+
+		//anything caching this subtree needs to know
+		if (node->GetSprite() != sprite) {
+			node->SetSprite(sprite);
+			tree.Touch(it);
 		}
-		return 0;
-	});
+	}
+	tree.ClearTypeChanges();
 }
\ No newline at end of file
@@ -23,10 +23,22 @@
 
 #include "base_scene.hpp"
 
+#include "camera.hpp"
+#include "growth_journal.hpp"
+#include "impostor_cache.hpp"
 #include "image.hpp"
+#include "lsystem.hpp"
 #include "node.hpp"
+#include "node_visitor.hpp"
+#include "render_cache.hpp"
+#include "species.hpp"
+#include "sprite_batch.hpp"
 #include "texture_loader.hpp"
+#include "tree_file.hpp"
+#include "tree_grower.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <functional>
 #include <iostream>
@@ -38,6 +50,10 @@ public:
 
 	void RenderFrame(SDL_Renderer* renderer) override;
 
+	//threaded mode
+	bool WriteSnapshot(RenderSnapshot* snapshot) override;
+	void DrawSnapshot(SDL_Renderer* renderer, RenderSnapshot* snapshot, bool fresh) override;
+
 private:
 	//frame phases
 	void FrameStart() override;
@@ -51,13 +67,27 @@ private:
 	void MouseWheel(SDL_MouseWheelEvent const& event) override;
 	void KeyDown(SDL_KeyboardEvent const& event) override;
 	void KeyUp(SDL_KeyboardEvent const& event) override;
+	void WindowResized(int w, int h) override;
 
+	void DrawScene(SpriteBatch* batch, ImpostorCache* cache);
+	void ClearPlant();
 	void CorrectSprites();
 
 	//members
-	Node* rootNode;
+	NodeTree tree;
+	GrowthJournal journal; //everything done to the tree since it was seeded
+	TreeGrower grower;
+	void (*growPlant)(NodeTree*, TreeGrower*) = growSpecies<CherryBlossom>; //picked with the number keys
 	TextureLoader& textureLoader = TextureLoader::GetSingleton();
-	Image potImage;
-	int potX = 0;
-	int potY = 0;
+	TextureHandle typeSprites[3] = {NO_TEXTURE, NO_TEXTURE, NO_TEXTURE}; //by Node::Type
+	Camera camera;
+	Vector2 mouse = {0, 0}; //the last known cursor position, on screen
+	SpriteBatch spriteBatch;
+	RenderCache renderCache;
+	ImpostorCache impostors;
+	bool redrawAll = true; //more changed than the tree's dirty bounds cover
+	RenderCache snapshotCache; //only touched by the render thread
+	SpriteBatch snapshotBatch; //likewise
+	int spritePadding = 0; //largest node sprite
+	TextureHandle potSprite = NO_TEXTURE; //under the root
 };
@@ -0,0 +1,278 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+constexpr int FrameProfiler::windowSize;
+
+FrameProfiler::FrameProfiler(std::string n): name(n) {
+	//start the shared timeline
+	Now();
+	history.resize(windowSize);
+	scratch.reserve(windowSize);
+	current = Frame();
+}
+
+void FrameProfiler::BeginFrame() {
+	current = Frame();
+	current.start = lapStart = Now();
+}
+
+void FrameProfiler::Lap(Phase phase) {
+	double now = Now();
+	current.phases[phase] += now - lapStart;
+	if (recording) {
+		spans.push_back({phase, lapStart, now - lapStart});
+	}
+	lapStart = now;
+}
+
+void FrameProfiler::CountStep() {
+	current.steps++;
+}
+
+void FrameProfiler::EndFrame() {
+	current.total = Now() - current.start;
+
+	history[head] = current;
+	head = (head + 1) % windowSize;
+	filled = std::min(filled + 1, windowSize);
+
+	if (recording) {
+		frames.push_back(current);
+	}
+}
+
+double FrameProfiler::GetPercentile(int phase, double fraction) {
+	if (filled == 0) {
+		return 0;
+	}
+
+	scratch.clear();
+	for (int i = 0; i < filled; i++) {
+		scratch.push_back(phase == PHASE_COUNT ? history[i].total : history[i].phases[phase]);
+	}
+
+	//nearest rank
+	std::size_t rank = std::min<std::size_t>(scratch.size() - 1, fraction * scratch.size());
+	std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+	return scratch[rank] / 1000.0;
+}
+
+int FrameProfiler::GetMaxSteps() {
+	int steps = 0;
+	for (int i = 0; i < filled; i++) {
+		steps = std::max(steps, history[i].steps);
+	}
+	return steps;
+}
+
+void FrameProfiler::WriteSummary(std::ostream& os) {
+	os << name << " frame timings over the last " << filled << " frames (p50 / p95 / p99 ms):" << std::endl;
+	os << std::fixed << std::setprecision(3);
+	for (int i = 0; i <= PHASE_COUNT; i++) {
+		os << "\t" << std::setw(14) << std::left << GetPhaseName(i) << std::right;
+		os << GetPercentile(i, 0.50) << " / " << GetPercentile(i, 0.95) << " / " << GetPercentile(i, 0.99) << std::endl;
+	}
+	os << "\tmost steps in a frame: " << GetMaxSteps() << std::endl;
+}
+
+bool FrameProfiler::SetRecording(bool b) {
+	return recording = b;
+}
+
+bool FrameProfiler::GetRecording() {
+	return recording;
+}
+
+void FrameProfiler::WriteCSV(std::string const& fname) {
+	WriteCSV(fname, {this});
+}
+
+void FrameProfiler::WriteCSV(std::string const& fname, std::vector<FrameProfiler*> const& profilers) {
+	std::ofstream os(fname);
+	if (!os.is_open()) {
+		std::ostringstream msg;
+		msg << "Failed to open the profile CSV: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	os << "thread,frame,start_us,steps";
+	for (int i = 0; i <= PHASE_COUNT; i++) {
+		os << "," << GetPhaseName(i) << "_us";
+	}
+	os << std::endl;
+
+	os << std::fixed << std::setprecision(1);
+	for (auto& profiler : profilers) {
+		std::vector<Frame>& frames = profiler->frames;
+		for (std::size_t i = 0; i < frames.size(); i++) {
+			os << profiler->name << "," << i << "," << frames[i].start << "," << frames[i].steps;
+			for (auto& it : frames[i].phases) {
+				os << "," << it;
+			}
+			os << "," << frames[i].total << std::endl;
+		}
+	}
+}
+
+void FrameProfiler::WriteTrace(std::string const& fname) {
+	WriteTrace(fname, {this});
+}
+
+void FrameProfiler::WriteTrace(std::string const& fname, std::vector<FrameProfiler*> const& profilers) {
+	std::ofstream os(fname);
+	if (!os.is_open()) {
+		std::ostringstream msg;
+		msg << "Failed to open the profile trace: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	//chrome://tracing and Perfetto read complete ("X"), counter ("C") and metadata ("M") events
+	os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+	os << std::fixed << std::setprecision(1);
+
+	bool first = true;
+	for (std::size_t i = 0; i < profilers.size(); i++) {
+		profilers[i]->WriteTraceEvents(os, i + 1, &first);
+	}
+
+	os << std::endl << "]}" << std::endl;
+}
+
+void FrameProfiler::DrawOverlay(SDL_Renderer* renderer) {
+	constexpr int barWidth = 2;
+	constexpr int graphHeight = 200;
+	constexpr double pixelsPerMs = 4;
+	constexpr SDL_Color colors[PHASE_COUNT] = {
+		{128, 128, 255, 255}, //FrameStart
+		{255, 128, 255, 255}, //ProcessEvents
+		{64, 224, 64, 255}, //Update
+		{0, 160, 160, 255}, //FrameEnd
+		{255, 160, 0, 255}, //RenderFrame
+		{224, 64, 64, 255}, //Present
+		{160, 96, 32, 255}, //Snapshot
+		{224, 224, 96, 255}, //Upload
+		{80, 80, 80, 255} //Idle
+	};
+
+	//don't disturb the scene's drawing state
+	Uint8 r, g, b, a;
+	SDL_BlendMode blendMode;
+	SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+	SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+
+	int w = 0, h = 0;
+	SDL_RenderGetLogicalSize(renderer, &w, &h);
+	if (w == 0 || h == 0) {
+		SDL_GetRendererOutputSize(renderer, &w, &h);
+	}
+	int bottom = h;
+
+	//backdrop
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+	SDL_Rect backdrop = {0, bottom - graphHeight, windowSize * barWidth, graphHeight};
+	SDL_RenderFillRect(renderer, &backdrop);
+
+	//oldest frame on the left, each bar stacks the phases bottom up
+	for (int i = 0; i < filled; i++) {
+		Frame& frame = history[(head - filled + i + windowSize) % windowSize];
+		int x = (windowSize - filled + i) * barWidth;
+		double y = bottom;
+
+		for (int p = 0; p < PHASE_COUNT && y > bottom - graphHeight; p++) {
+			double height = std::min(frame.phases[p] / 1000.0 * pixelsPerMs, y - (bottom - graphHeight));
+			SDL_Rect rect = {x, int(y - height), barWidth, std::max(1, int(height))};
+			if (height >= 0.5) {
+				SDL_SetRenderDrawColor(renderer, colors[p].r, colors[p].g, colors[p].b, colors[p].a);
+				SDL_RenderFillRect(renderer, &rect);
+			}
+			y -= height;
+		}
+
+		//catch-up frames get a tick per extra step
+		for (int s = 1; s < frame.steps && s < 10; s++) {
+			SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+			SDL_Rect tick = {x, bottom - graphHeight + s * 3, barWidth, 2};
+			SDL_RenderFillRect(renderer, &tick);
+		}
+	}
+
+	//the frame budget, then the rolling p50 and p99 of the whole frame
+	auto line = [&](double ms, Uint8 cr, Uint8 cg, Uint8 cb) {
+		int y = bottom - std::min<int>(graphHeight, ms * pixelsPerMs);
+		SDL_SetRenderDrawColor(renderer, cr, cg, cb, 255);
+		SDL_RenderDrawLine(renderer, 0, y, windowSize * barWidth, y);
+	};
+	line(16, 255, 255, 255);
+	line(GetPercentile(PHASE_COUNT, 0.50), 0, 255, 0);
+	line(GetPercentile(PHASE_COUNT, 0.99), 255, 0, 0);
+
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	SDL_SetRenderDrawBlendMode(renderer, blendMode);
+}
+
+char const* FrameProfiler::GetPhaseName(int phase) {
+	static char const* names[PHASE_COUNT + 1] = {
+		"FrameStart",
+		"ProcessEvents",
+		"Update",
+		"FrameEnd",
+		"RenderFrame",
+		"Present",
+		"Snapshot",
+		"Upload",
+		"Idle",
+		"Total"
+	};
+	return names[phase];
+}
+
+void FrameProfiler::WriteTraceEvents(std::ostream& os, int thread, bool* first) {
+	auto event = [&](char const* name, char const* type, double ts) -> std::ostream& {
+		os << (*first ? "" : ",\n");
+		*first = false;
+		os << "{\"name\": \"" << name << "\", \"ph\": \"" << type << "\", \"pid\": 1, \"tid\": " << thread << ", \"ts\": " << ts;
+		return os;
+	};
+
+	event("thread_name", "M", 0) << ", \"args\": {\"name\": \"" << name << "\"}}";
+	for (auto& it : frames) {
+		event("Frame", "X", it.start) << ", \"dur\": " << it.total << ", \"args\": {\"steps\": " << it.steps << "}}";
+		event("Steps", "C", it.start) << ", \"args\": {\"steps\": " << it.steps << "}}";
+	}
+	for (auto& it : spans) {
+		event(GetPhaseName(it.phase), "X", it.start) << ", \"dur\": " << it.duration << "}";
+	}
+}
+
+double FrameProfiler::Now() {
+	//every profiler shares one timeline, so their traces line up
+	static Clock::time_point const epoch = Clock::now();
+	return std::chrono::duration<double, std::micro>(Clock::now() - epoch).count();
+}
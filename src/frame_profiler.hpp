@@ -0,0 +1,110 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "SDL2/SDL.h"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//DOCS: FrameProfiler times each phase of the game loop, and counts the simulation steps run per frame
+//DOCS: Lap() charges the time since the previous lap to a phase, a phase can run several times per frame
+//DOCS: percentiles cover the last windowSize frames, recording keeps every frame for a CSV or Chrome trace dump
+class FrameProfiler {
+public:
+	enum Phase {
+		FRAME_START = 0,
+		PROCESS_EVENTS,
+		UPDATE,
+		FRAME_END,
+		RENDER_FRAME,
+		PRESENT,
+		SNAPSHOT,
+		UPLOAD,
+		IDLE,
+		PHASE_COUNT
+	};
+
+	FrameProfiler(std::string name = "Main");
+	~FrameProfiler() = default;
+
+	void BeginFrame();
+	void Lap(Phase phase);
+	void CountStep();
+	void EndFrame();
+
+	//in milliseconds, PHASE_COUNT gives the whole frame
+	double GetPercentile(int phase, double fraction);
+	int GetMaxSteps();
+	void WriteSummary(std::ostream& os);
+
+	//keeps every frame from now on
+	bool SetRecording(bool b);
+	bool GetRecording();
+	void WriteCSV(std::string const& fname);
+	void WriteTrace(std::string const& fname);
+
+	//one file covering several profilers, for profilers on different threads
+	static void WriteCSV(std::string const& fname, std::vector<FrameProfiler*> const& profilers);
+	static void WriteTrace(std::string const& fname, std::vector<FrameProfiler*> const& profilers);
+
+	//stacked bars of the recent frames, in the bottom left corner
+	void DrawOverlay(SDL_Renderer* renderer);
+
+	static constexpr int windowSize = 300;
+	static char const* GetPhaseName(int phase);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Frame {
+		double start; //microseconds since the first profiler was made
+		double phases[PHASE_COUNT]; //microseconds
+		double total;
+		int steps;
+	};
+
+	struct Span {
+		Phase phase;
+		double start;
+		double duration;
+	};
+
+	double Now();
+	void WriteTraceEvents(std::ostream& os, int thread, bool* first);
+
+	std::string name;
+	double lapStart = 0;
+	Frame current;
+
+	//the rolling window
+	std::vector<Frame> history;
+	int head = 0;
+	int filled = 0;
+	std::vector<double> scratch;
+
+	bool recording = false;
+	std::vector<Frame> frames;
+	std::vector<Span> spans;
+};
@@ -0,0 +1,195 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "growth_journal.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+GrowthJournal::GrowthJournal(std::size_t i, std::size_t m): interval(i), maxCheckpoints(std::max<std::size_t>(m, 2)) {
+	//EMPTY
+}
+
+GrowthJournal::~GrowthJournal() {
+	Stop();
+}
+
+void GrowthJournal::Start(NodeTree* t) {
+	Stop();
+	records.clear();
+	origins.clear();
+	checkpoints.clear();
+
+	tree = t;
+	tree->SetJournal(this);
+	checkpoints.push_back({0, *tree});
+	checkpoints.back().tree.SetJournal(nullptr);
+}
+
+void GrowthJournal::Stop() {
+	if (tree && tree->GetJournal() == this) {
+		tree->SetJournal(nullptr);
+	}
+	tree = nullptr;
+}
+
+void GrowthJournal::Append(JournalRecord const& record) {
+	//its origin would be missing
+	if (record.kind == JournalRecord::PLACE_NODE) {
+		throw(std::logic_error("PLACE_NODE records have to be appended with AppendPlace()"));
+	}
+	records.push_back(record);
+	KeepCheckpoint();
+}
+
+void GrowthJournal::AppendPlace(NodeIndex node, Vector2 origin) {
+	origins.push_back(origin);
+	records.push_back({JournalRecord::PLACE_NODE, 0, 0, node, std::int32_t(origins.size() - 1), 0});
+	KeepCheckpoint();
+}
+
+void GrowthJournal::AppendRecords(GrowthJournal const& source) {
+	if (&source == this) {
+		throw(std::logic_error("Can't append a journal to itself"));
+	}
+
+	//the tree hasn't been through these, so there's nothing to copy, replays start from the last copy before them
+	records.reserve(records.size() + source.records.size());
+	for (auto& it : source.records) {
+		records.push_back(it);
+		if (it.kind == JournalRecord::PLACE_NODE) {
+			origins.push_back(source.origins[it.a]);
+			records.back().a = std::int32_t(origins.size() - 1);
+		}
+	}
+}
+
+void GrowthJournal::KeepCheckpoint() {
+	//the copies can't outgrow the records
+	Checkpoint& last = checkpoints.back();
+	std::size_t since = records.size() - last.step;
+	if (tree && since >= std::max<std::size_t>(interval, last.tree.Size())) {
+		checkpoints.push_back({records.size(), *tree});
+		checkpoints.back().tree.SetJournal(nullptr);
+	}
+
+	//every other copy goes, counting back from the newest, so the gaps grow with their age
+	if (checkpoints.size() > maxCheckpoints) {
+		bool drop = false;
+		for (auto it = std::prev(checkpoints.end()); it != checkpoints.begin(); drop = !drop) {
+			auto prev = std::prev(it);
+			if (drop) {
+				checkpoints.erase(it);
+			}
+			it = prev;
+		}
+	}
+}
+
+void GrowthJournal::Replay(NodeTree* t, std::size_t step) {
+	if (t == tree) {
+		throw(std::logic_error("Can't replay a journal into its own tree"));
+	}
+	if (checkpoints.empty() || step > records.size()) {
+		std::ostringstream msg;
+		msg << "Can't replay a journal to step " << step << " of " << records.size();
+		throw(std::out_of_range(msg.str()));
+	}
+
+	//the last copy at or before the step, there are only a few
+	auto it = checkpoints.rbegin();
+	while (it->step > step) {
+		++it;
+	}
+	Checkpoint& checkpoint = *it;
+
+	*t = checkpoint.tree;
+	for (std::size_t i = checkpoint.step; i < step; i++) {
+		Apply(t, records[i]);
+	}
+}
+
+std::vector<JournalRecord> const& GrowthJournal::GetRecords() {
+	return records;
+}
+
+Vector2 GrowthJournal::GetOrigin(JournalRecord const& record) {
+	if (record.kind != JournalRecord::PLACE_NODE || record.a < 0 || std::size_t(record.a) >= origins.size()) {
+		throw(std::out_of_range("Journal record has no origin in this journal"));
+	}
+	return origins[record.a];
+}
+
+std::size_t GrowthJournal::Size() {
+	return records.size();
+}
+
+int GrowthJournal::GetCheckpointCount() {
+	return checkpoints.size();
+}
+
+void GrowthJournal::Apply(NodeTree* tree, JournalRecord const& record) {
+	switch(record.kind) {
+		case JournalRecord::ADD_CHILD:
+			addChildNode(tree, record.node, record.a, record.b);
+		break;
+
+		case JournalRecord::SET_TYPE:
+			tree->SetType(record.node, Node::Type(record.type));
+		break;
+
+		case JournalRecord::PRUNE:
+			destroyTree(tree, record.node);
+		break;
+
+		case JournalRecord::CLEAR:
+			tree->Clear();
+		break;
+
+		case JournalRecord::SET_SEED:
+			tree->SetSeed(std::uint64_t(std::uint32_t(record.b)) << 32 | std::uint32_t(record.a));
+		break;
+
+		case JournalRecord::SET_DIRECTION:
+			tree->SetDirection(record.node, record.a);
+		break;
+
+		case JournalRecord::SET_LENGTH:
+			tree->SetLength(record.node, record.a);
+		break;
+
+		case JournalRecord::UPDATE_ORIGINS:
+			tree->UpdateOrigins();
+		break;
+
+		case JournalRecord::PLACE_NODE:
+			tree->PlaceNode(record.node, GetOrigin(record));
+		break;
+
+		default: {
+			std::ostringstream msg;
+			msg << "Unknown journal record kind " << int(record.kind);
+			throw(std::runtime_error(msg.str()));
+		}
+	}
+}
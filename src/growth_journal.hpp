@@ -0,0 +1,102 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "node.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+//DOCS: JournalRecord is one structural change to a NodeTree, the same 16 bytes whatever the kind
+struct JournalRecord {
+	enum Kind : std::uint8_t {
+		ADD_CHILD, //addChildNode(), node is the parent, a & b are the direction & length
+		SET_TYPE, //NodeTree::SetType(), node & type
+		PRUNE, //destroyTree(), node is the subtree's root
+		CLEAR, //NodeTree::Clear()
+		SET_SEED, //NodeTree::SetSeed(), a & b are the low & high halves
+		SET_DIRECTION, //NodeTree::SetDirection(), node & a
+		SET_LENGTH, //NodeTree::SetLength(), node & a
+		UPDATE_ORIGINS, //NodeTree::UpdateOrigins(), when it moved anything
+		PLACE_NODE //NodeTree::PlaceNode() moving a placed node, node & a, which indexes its journal's origins
+	};
+
+	Kind kind;
+	std::uint8_t type;
+	std::uint16_t reserved;
+	NodeIndex node;
+	std::int32_t a;
+	std::int32_t b;
+};
+
+static_assert(sizeof(JournalRecord) == 16, "JournalRecord isn't 16 bytes");
+
+//DOCS: GrowthJournal records the changes made to the NodeTree it's attached to, in order, and only ever appends
+//DOCS: those are addChildNode(), destroyTree() and NodeTree's SetType(), Clear(), SetSeed(), SetDirection(), SetLength(), UpdateOrigins() and PlaceNode()
+//DOCS: the origins don't fit in a record, so they're kept alongside the records, use AppendRecords() or GetOrigin() to carry them over
+//DOCS: the operations are deterministic, so replaying the records on a copy of the starting tree rebuilds it exactly, slot for slot
+//DOCS: a copy of the tree is kept every interval records, or after as many records as the last copy has nodes if that's longer
+//DOCS: so a replay starts from the nearest copy, and the copies hold at most about one node per record
+//DOCS: past maxCheckpoints copies every other one is dropped, except the first & last, so the older history thins out rather than grows
+//NOTE: a copy of a journaled tree records into the same journal, detach it with SetJournal(nullptr)
+class GrowthJournal {
+public:
+	GrowthJournal(std::size_t interval = 4096, std::size_t maxCheckpoints = 32);
+	~GrowthJournal();
+
+	//attaches to the tree, the old records are dropped and the tree as it is now is step 0
+	void Start(NodeTree* tree);
+	void Stop();
+
+	//called by the recorded operations, after they've finished, PLACE_NODE has to go through AppendPlace()
+	void Append(JournalRecord const& record);
+	void AppendPlace(NodeIndex node, Vector2 origin);
+
+	//copies another journal's records onto the end of this one, origins included, without applying them to the tree
+	void AppendRecords(GrowthJournal const& source);
+
+	//rebuilds the tree as it was after the given number of records, detached from any journal
+	void Replay(NodeTree* tree, std::size_t step);
+
+	std::vector<JournalRecord> const& GetRecords();
+	Vector2 GetOrigin(JournalRecord const& record); //for PLACE_NODE
+	std::size_t Size();
+	int GetCheckpointCount();
+
+private:
+	struct Checkpoint {
+		std::size_t step;
+		NodeTree tree;
+	};
+
+	void KeepCheckpoint();
+	void Apply(NodeTree* tree, JournalRecord const& record);
+
+	NodeTree* tree = nullptr;
+	std::size_t interval;
+	std::size_t maxCheckpoints;
+	std::vector<JournalRecord> records;
+	std::vector<Vector2> origins; //for PLACE_NODE
+	std::list<Checkpoint> checkpoints; //dropping one doesn't copy the others
+};
@@ -38,9 +38,11 @@ Image& Image::operator=(Image const& rhs) {
 	texture = rhs.texture;
 	clip = rhs.clip;
 	local = false;
+
+	return *this;
 }
 
-Image& Image::operator=(Image&& rhs) {
+Image& Image::operator=(Image&& rhs) noexcept {
 	//don't screw yourself
 	if (this == &rhs) {
 		return *this;
@@ -56,6 +58,8 @@ Image& Image::operator=(Image&& rhs) {
 	rhs.texture = nullptr;
 	rhs.clip = {0, 0, 0, 0};
 	rhs.local = false;
+
+	return *this;
 }
 
 SDL_Texture* Image::Load(SDL_Renderer* renderer, std::string fname) {
@@ -95,6 +99,31 @@ SDL_Texture* Image::Load(SDL_Renderer* renderer, std::string fname) {
 	return texture;
 }
 
+SDL_Texture* Image::Load(SDL_Renderer* renderer, SDL_Surface* surface) {
+	Free();
+
+	//the surface still belongs to the caller
+	texture = SDL_CreateTextureFromSurface(renderer, surface);
+	if (!texture) {
+		std::ostringstream msg;
+		msg << "Failed to convert a surface to a texture; " << SDL_GetError();
+		throw(std::runtime_error(msg.str()));
+	}
+
+	//set the metadata
+	clip.x = 0;
+	clip.y = 0;
+	if (SDL_QueryTexture(texture, nullptr, nullptr, &clip.w, &clip.h)) {
+		std::ostringstream msg;
+		msg << "Failed to record metadata for a converted surface";
+		msg << "; " << SDL_GetError();
+		throw(std::runtime_error(msg.str()));
+	}
+	local = true;
+
+	return texture;
+}
+
 SDL_Texture* Image::Create(SDL_Renderer* renderer, Uint16 w, Uint16 h, SDL_Color blank) {
 	Free();
 
@@ -156,6 +185,11 @@ SDL_Texture* Image::SetTexture(SDL_Texture* ptr) {
 
 	texture = ptr;
 
+	//nothing to query
+	if (!texture) {
+		return nullptr;
+	}
+
 	//set the metadata
 	clip.x = 0;
 	clip.y = 0;
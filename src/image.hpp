@@ -29,16 +29,18 @@ class Image {
 public:
 	Image() = default;
 	Image(Image const& rhs) { *this = rhs; }
-	Image(Image&& rhs) { *this = std::move(rhs); }
+	//moves are noexcept so containers move the owning images as they grow, rather than copy & free them
+	Image(Image&& rhs) noexcept { *this = std::move(rhs); }
 	Image(SDL_Renderer* r, std::string fname) { Load(r, fname); }
 	Image(SDL_Renderer* r, Uint16 w, Uint16 h) { Create(r, w, h); }
 	Image(SDL_Texture* p) { SetTexture(p); }
 	virtual ~Image() { Free(); }
 
 	Image& operator=(Image const&);
-	Image& operator=(Image&&);
+	Image& operator=(Image&&) noexcept;
 
 	SDL_Texture* Load(SDL_Renderer* renderer, std::string fname);
+	SDL_Texture* Load(SDL_Renderer* renderer, SDL_Surface* surface);
 	SDL_Texture* Create(SDL_Renderer* renderer, Uint16 w, Uint16 h, SDL_Color blank = {0, 0, 0, 255});
 	SDL_Texture* CopyTexture(SDL_Renderer* renderer, SDL_Texture* ptr);
 	SDL_Texture* SetTexture(SDL_Texture*);
@@ -0,0 +1,169 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "impostor_cache.hpp"
+
+#include "node_visitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void ImpostorCache::Create(SDL_Renderer* r, int pageSize, int size) {
+	renderer = r;
+	slotSize = size;
+	slotsPerRow = pageSize / slotSize;
+
+	page.Create(renderer, pageSize, pageSize, {0, 0, 0, 0});
+	SDL_SetTextureBlendMode(page.GetTexture(), SDL_BLENDMODE_BLEND);
+
+	slots.assign(slotsPerRow * slotsPerRow, Slot());
+	lookup.clear();
+	hand = 0;
+}
+
+void ImpostorCache::Clear() {
+	//the atlas is overwritten as the slots are reused
+	for (auto& it : slots) {
+		it = Slot();
+	}
+	lookup.clear();
+}
+
+void ImpostorCache::NextFrame() {
+	frame++;
+	drawCount = 0;
+	redrawCount = 0;
+}
+
+bool ImpostorCache::Draw(SpriteBatch* spriteBatch, NodeTree* tree, NodeIndex index, Camera const& camera, int padding) {
+	if (!page.GetTexture()) {
+		return false;
+	}
+
+	Node* node = tree->GetNode(index);
+	if (node->GetNodeCount() < minNodes) {
+		return false;
+	}
+
+	//the area the subtree's sprites can cover
+	BoundingBox bounds = node->GetBounds();
+	BoundingBox box(bounds.minX - padding, bounds.minY - padding, bounds.maxX + padding, bounds.maxY + padding);
+	double zoom = camera.GetZoom();
+	if ((box.maxX - box.minX) * zoom > slotSize || (box.maxY - box.minY) * zoom > slotSize) {
+		return false;
+	}
+
+	Slot* slot = FindSlot(index);
+	if (slot && slot->revision != node->GetRevision()) {
+		if (redrawCount >= redrawsPerFrame) {
+			return false;
+		}
+		Redraw(slot, tree, index, box);
+	}
+	else if (!slot) {
+		if (redrawCount >= redrawsPerFrame || fullFrame == frame) {
+			return false;
+		}
+
+		//take the next slot that's been idle for a frame, so a full atlas doesn't thrash
+		for (int i = 0; i < int(slots.size()) && !slot; i++) {
+			hand = (hand + 1) % slots.size();
+			if (slots[hand].lastUsed < frame - 1) {
+				slot = &slots[hand];
+			}
+		}
+		if (!slot) {
+			fullFrame = frame;
+			return false;
+		}
+
+		auto found = lookup.find(slot->node);
+		if (found != lookup.end() && found->second == hand) {
+			lookup.erase(found);
+		}
+		lookup[index] = hand;
+		Redraw(slot, tree, index, box);
+	}
+
+	slot->lastUsed = frame;
+	drawCount++;
+
+	Vector2 draw = camera.WorldToScreen({box.minX, box.minY});
+	spriteBatch->Draw(page.GetTexture(), slot->rect, draw.x, draw.y, (box.maxX - box.minX) * zoom, (box.maxY - box.minY) * zoom);
+	return true;
+}
+
+int ImpostorCache::GetDrawCount() {
+	return drawCount;
+}
+
+int ImpostorCache::GetRedrawCount() {
+	return redrawCount;
+}
+
+ImpostorCache::Slot* ImpostorCache::FindSlot(NodeIndex index) {
+	auto found = lookup.find(index);
+	if (found == lookup.end()) {
+		return nullptr;
+	}
+	return &slots[found->second];
+}
+
+void ImpostorCache::Redraw(Slot* slot, NodeTree* tree, NodeIndex index, BoundingBox const& box) {
+	//fit the longer side to the slot
+	int number = slot - slots.data();
+	double scale = slotSize / std::max(box.maxX - box.minX, box.maxY - box.minY);
+	SDL_Rect full = {number % slotsPerRow * slotSize, number / slotsPerRow * slotSize, slotSize, slotSize};
+	slot->rect = {full.x, full.y, std::max(1, int(std::ceil((box.maxX - box.minX) * scale))), std::max(1, int(std::ceil((box.maxY - box.minY) * scale)))};
+	slot->node = index;
+	slot->revision = tree->GetNode(index)->GetRevision();
+
+	TextureLoader& textures = TextureLoader::GetSingleton();
+	forEachNode(tree, index, [&](Node* node) -> int {
+		Image* sprite = textures.GetImage(node->GetSprite());
+		if (!sprite) {
+			return Visit::CONTINUE;
+		}
+		float x = full.x + (node->GetOrigin().x - sprite->GetClipW() / 2 - box.minX) * scale;
+		float y = full.y + (node->GetOrigin().y - box.minY) * scale;
+		batch.Draw(sprite->GetTexture(), sprite->GetClip(), x, y, sprite->GetClipW() * scale, sprite->GetClipH() * scale);
+		return Visit::CONTINUE;
+	});
+
+	//this can happen in the middle of drawing to another target
+	SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+	SDL_Rect clip;
+	SDL_RenderGetClipRect(renderer, &clip);
+	bool clipped = SDL_RenderIsClipEnabled(renderer);
+
+	//wipe the slot back to transparent, then draw the subtree into it
+	SDL_SetRenderTarget(renderer, page.GetTexture());
+	SDL_RenderSetClipRect(renderer, &full);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderFillRect(renderer, &full);
+	batch.Flush(renderer);
+
+	SDL_SetRenderTarget(renderer, previous);
+	SDL_RenderSetClipRect(renderer, clipped ? &clip : nullptr);
+
+	redrawCount++;
+}
@@ -0,0 +1,89 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "camera.hpp"
+#include "image.hpp"
+#include "node.hpp"
+#include "sprite_batch.hpp"
+
+#include "SDL2/SDL.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//DOCS: ImpostorCache draws a subtree that's small on screen as one sprite, a snapshot of the whole subtree
+//DOCS: The snapshots share one atlas texture, so every impostor in a frame is a single draw call
+//DOCS: A snapshot is redrawn when its subtree's revision changes, but only when it's next drawn
+//NOTE: this renders to textures, so it belongs to the render thread
+class ImpostorCache {
+public:
+	ImpostorCache() = default;
+	~ImpostorCache() = default;
+
+	//the atlas is pageSize squared, split into slots of slotSize squared
+	void Create(SDL_Renderer* renderer, int pageSize = 2048, int slotSize = 64);
+	void Clear();
+
+	//call once per frame, before drawing
+	void NextFrame();
+
+	//true if the subtree was drawn as an impostor, its nodes don't need drawing
+	bool Draw(SpriteBatch* batch, NodeTree* tree, NodeIndex index, Camera const& camera, int padding);
+
+	//stats for the current frame
+	int GetDrawCount();
+	int GetRedrawCount();
+
+private:
+	struct Slot {
+		NodeIndex node = NO_NODE;
+		std::uint64_t revision = 0;
+		int lastUsed = -1;
+		SDL_Rect rect = {0, 0, 0, 0}; //the part of the slot in use
+	};
+
+	Slot* FindSlot(NodeIndex index);
+	void Redraw(Slot* slot, NodeTree* tree, NodeIndex index, BoundingBox const& box);
+
+	SDL_Renderer* renderer = nullptr;
+	Image page;
+	SpriteBatch batch;
+	int slotSize = 0;
+	int slotsPerRow = 0;
+
+	std::vector<Slot> slots;
+	std::unordered_map<NodeIndex, int> lookup;
+	int hand = 0; //the next eviction candidate
+	int fullFrame = -1; //the last frame every slot was busy
+
+	int frame = 0;
+	int drawCount = 0;
+	int redrawCount = 0;
+
+	//smaller subtrees are cheaper to draw directly
+	static constexpr int minNodes = 16;
+
+	//regenerating switches render targets, so only this many each frame
+	static constexpr int redrawsPerFrame = 64;
+};
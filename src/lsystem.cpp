@@ -0,0 +1,257 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "lsystem.hpp"
+
+#include "branch_random.hpp"
+#include "direction_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+void LSystem::AddRule(char predecessor, std::vector<Successor> successors, int weight, float minValue) {
+	if (weight <= 0) {
+		std::ostringstream msg;
+		msg << "Bad L-system rule weight for " << predecessor << ": " << weight;
+		throw(std::invalid_argument(msg.str()));
+	}
+	if (rules[std::uint8_t(predecessor)].size() >= noProduction) {
+		std::ostringstream msg;
+		msg << "Too many L-system rules for " << predecessor;
+		throw(std::length_error(msg.str()));
+	}
+	rules[std::uint8_t(predecessor)].push_back({weight, minValue, std::move(successors)});
+}
+
+void LSystem::Rewrite(std::vector<LSymbol> const& input, std::vector<LSymbol>* output, std::uint64_t seed, int iteration, WorkerPool* pool) {
+	std::size_t chunks = 1;
+	if (pool) {
+		chunks = std::max<std::size_t>(1, std::min<std::size_t>(pool->GetThreadCount() * 4, input.size() / minChunkSize));
+	}
+	chunkSizes.assign(chunks + 1, 0);
+	picks.resize(input.size());
+
+	//measure each chunk's output, then write them side by side
+	auto measureChunk = [&](int chunk) {
+		std::size_t begin = input.size() * chunk / chunks;
+		std::size_t end = input.size() * (chunk + 1) / chunks;
+		std::vector<Production> const* letterRules = rules;
+		std::size_t size = 0;
+		for (std::size_t i = begin; i < end; i++) {
+			std::uint8_t pick = picks[i] = Pick(input[i], seed, iteration, i);
+			size += pick == noProduction ? 1 : letterRules[std::uint8_t(input[i].letter)][pick].successors.size();
+		}
+		chunkSizes[chunk + 1] = size;
+	};
+
+	auto writeChunk = [&](int chunk) {
+		std::size_t begin = input.size() * chunk / chunks;
+		std::size_t end = input.size() * (chunk + 1) / chunks;
+		LSymbol* out = output->data() + chunkSizes[chunk];
+		for (std::size_t i = begin; i < end; i++) {
+			if (picks[i] == noProduction) {
+				*out++ = input[i];
+				continue;
+			}
+			for (auto& it : rules[std::uint8_t(input[i].letter)][picks[i]].successors) {
+				*out++ = {it.letter, it.scale * input[i].value + it.offset};
+			}
+		}
+	};
+
+	if (chunks > 1) {
+		pool->ParallelFor(chunks, measureChunk);
+	}
+	else {
+		measureChunk(0);
+	}
+
+	for (std::size_t i = 0; i < chunks; i++) {
+		chunkSizes[i + 1] += chunkSizes[i];
+	}
+	output->resize(chunkSizes[chunks]);
+
+	if (chunks > 1) {
+		pool->ParallelFor(chunks, writeChunk);
+	}
+	else {
+		writeChunk(0);
+	}
+}
+
+void LSystem::Expand(std::vector<LSymbol> const& axiom, int iterations, std::uint64_t seed, std::vector<LSymbol>* output, WorkerPool* pool) {
+	*output = axiom;
+	for (int i = 0; i < iterations; i++) {
+		Rewrite(*output, &scratch, seed, i, pool);
+		output->swap(scratch);
+	}
+}
+
+void LSystem::Interpret(std::vector<LSymbol> const& symbols, NodeTree* tree) {
+	types.clear();
+	directions.clear();
+	lengths.clear();
+	origins.clear();
+	keys.clear();
+	births.clear();
+	ends.clear();
+	path.clear();
+	stack.clear();
+
+	//the root stays where it is
+	Node* root = tree->GetNode(tree->GetRoot());
+	types.push_back(Node::Type::LEAF);
+	directions.push_back(root->GetDirection());
+	lengths.push_back(root->GetLength());
+	origins.push_back(root->GetOrigin());
+	keys.push_back(root->GetKey());
+	births.push_back(0);
+	ends.push_back(0);
+	path.push_back(0);
+
+	int heading = root->GetDirection();
+	for (auto& it : symbols) {
+		switch(it.letter) {
+			case 'F':
+				Emit(path.back(), heading, it.value, Node::Type::LEAF);
+				path.push_back(types.size() - 1);
+			break;
+
+			case 'K':
+				Emit(path.back(), heading, it.value, Node::Type::FLOWER);
+				Close(types.size() - 1);
+			break;
+
+			case '+':
+				heading += int(std::lround(it.value));
+			break;
+
+			case '-':
+				heading -= int(std::lround(it.value));
+			break;
+
+			case '[':
+				stack.push_back({path.size(), heading});
+			break;
+
+			case ']':
+				//an unmatched ] is ignored
+				if (stack.empty()) {
+					break;
+				}
+				while (path.size() > stack.back().first) {
+					Close(path.back());
+					path.pop_back();
+				}
+				heading = stack.back().second;
+				stack.pop_back();
+			break;
+		}
+	}
+
+	while (!path.empty()) {
+		Close(path.back());
+		path.pop_back();
+	}
+
+	NodeArrays arrays;
+	arrays.count = types.size();
+	arrays.types = types.data();
+	arrays.directions = directions.data();
+	arrays.lengths = lengths.data();
+	arrays.origins = origins.data();
+	arrays.keys = keys.data();
+	arrays.births = births.data();
+	arrays.ends = ends.data();
+	tree->Load(arrays);
+}
+
+std::uint8_t LSystem::Pick(LSymbol const& symbol, std::uint64_t seed, int iteration, std::size_t position) {
+	std::vector<Production> const& candidates = rules[std::uint8_t(symbol.letter)];
+
+	std::uint8_t only = noProduction;
+	int total = 0;
+	for (std::size_t i = 0; i < candidates.size(); i++) {
+		if (symbol.value >= candidates[i].minValue) {
+			only = i;
+			total += candidates[i].weight;
+		}
+	}
+
+	//only draw when there's a choice
+	if (only == noProduction || candidates[only].weight == total) {
+		return only;
+	}
+
+	int roll = BranchRandom(seed, iteration, position).Next() % total;
+	for (std::size_t i = 0; i < candidates.size(); i++) {
+		if (symbol.value >= candidates[i].minValue) {
+			if (roll < candidates[i].weight) {
+				return i;
+			}
+			roll -= candidates[i].weight;
+		}
+	}
+	return only;
+}
+
+void LSystem::Emit(NodeIndex parent, int heading, float value, Node::Type type) {
+	if (types.size() >= NO_NODE) {
+		throw(std::length_error("L-system tree is too big"));
+	}
+
+	int length = int(std::lround(value));
+	types.push_back(type);
+	directions.push_back(heading);
+	lengths.push_back(length);
+	origins.push_back(origins[parent] + directionTable[heading] * length);
+
+	//the same identities addChildNode() would give
+	keys.push_back(BranchRandom::ChildKey(keys[parent], births[parent]));
+	births[parent]++;
+	births.push_back(0);
+	ends.push_back(0);
+}
+
+void LSystem::Close(NodeIndex index) {
+	ends[index] = types.size();
+	if (types[index] != Node::Type::FLOWER) {
+		types[index] = ends[index] == index + 1 ? Node::Type::LEAF : Node::Type::STEM;
+	}
+}
+
+//-------------------------
+//public functions
+//-------------------------
+
+//a stochastic bush, most branches fork in two and a few end in a flower
+void generateLSystemBush(NodeTree* tree, int iterations, std::uint64_t seed, WorkerPool* pool) {
+	LSystem lsystem;
+	lsystem.AddRule('A', {{'F', 1, 0}, {'[', 0, 0}, {'+', 0, 22}, {'A', 0.9f, 0}, {']', 0, 0}, {'[', 0, 0}, {'-', 0, 22}, {'A', 0.9f, 0}, {']', 0, 0}}, 6);
+	lsystem.AddRule('A', {{'F', 1, 0}, {'[', 0, 0}, {'+', 0, 35}, {'A', 0.8f, 0}, {']', 0, 0}, {'-', 0, 8}, {'A', 0.95f, 0}}, 3);
+	lsystem.AddRule('A', {{'F', 1, 0}, {'K', 0, 4}}, 1);
+
+	std::vector<LSymbol> symbols;
+	lsystem.Expand({{'A', 40}}, iterations, seed, &symbols, pool);
+	lsystem.Interpret(symbols, tree);
+}
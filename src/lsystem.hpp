@@ -0,0 +1,98 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "node.hpp"
+#include "worker_pool.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+//DOCS: LSymbol is one module of an L-system string, a letter and its parameter
+struct LSymbol {
+	char letter;
+	float value;
+};
+
+//DOCS: LSystem is a parametric, stochastic L-system, rewritten as a flat buffer of symbols and then read by a turtle
+//DOCS: a production replaces a letter with successors, each successor's value is scale * the letter's value + offset
+//DOCS: a production applies when the letter's value is at least its minimum, when several apply one is picked by weight
+//DOCS: the picks are drawn from (seed, iteration, position), so the result doesn't depend on how the buffer is split
+//DOCS: the turtle reads F(length) as a branch, K(length) as a flower on the current branch, +(degrees) & -(degrees) as turns, and [ & ] as push & pop
+class LSystem {
+public:
+	struct Successor {
+		char letter;
+		float scale;
+		float offset;
+	};
+
+	LSystem() = default;
+	~LSystem() = default;
+
+	void AddRule(char predecessor, std::vector<Successor> successors, int weight = 1, float minValue = -std::numeric_limits<float>::infinity());
+
+	//one round of rewriting, split across the pool if there is one
+	void Rewrite(std::vector<LSymbol> const& input, std::vector<LSymbol>* output, std::uint64_t seed, int iteration, WorkerPool* pool = nullptr);
+
+	//the axiom after several rounds
+	void Expand(std::vector<LSymbol> const& axiom, int iterations, std::uint64_t seed, std::vector<LSymbol>* output, WorkerPool* pool = nullptr);
+
+	//replaces the tree with the one the symbols draw, in one pass, starting from the tree's root
+	void Interpret(std::vector<LSymbol> const& symbols, NodeTree* tree);
+
+private:
+	struct Production {
+		int weight;
+		float minValue;
+		std::vector<Successor> successors;
+	};
+
+	//the production for the symbol at this position, or noProduction to copy it unchanged
+	std::uint8_t Pick(LSymbol const& symbol, std::uint64_t seed, int iteration, std::size_t position);
+	void Emit(NodeIndex parent, int heading, float value, Node::Type type);
+	void Close(NodeIndex index);
+
+	//symbols smaller than this aren't split
+	static constexpr std::size_t minChunkSize = 4096;
+	static constexpr std::uint8_t noProduction = 255;
+
+	std::vector<Production> rules[256]; //by letter
+	std::vector<LSymbol> scratch;
+	std::vector<std::uint8_t> picks; //by input position, so each is only drawn once
+	std::vector<std::size_t> chunkSizes;
+
+	//the turtle's output
+	std::vector<std::uint8_t> types;
+	std::vector<std::int32_t> directions;
+	std::vector<std::int32_t> lengths;
+	std::vector<Vector2> origins;
+	std::vector<std::uint64_t> keys;
+	std::vector<std::int32_t> births;
+	std::vector<std::uint32_t> ends;
+	std::vector<NodeIndex> path; //the open branches, root first
+	std::vector<std::pair<std::size_t, int>> stack; //path length & heading at each [
+};
+
+//public functions
+void generateLSystemBush(NodeTree* tree, int iterations, std::uint64_t seed, WorkerPool* pool = nullptr);
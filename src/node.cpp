@@ -21,6 +21,18 @@
 */
 #include "node.hpp"
 
+#include "branch_random.hpp"
+#include "camera.hpp"
+#include "direction_table.hpp"
+#include "growth_journal.hpp"
+#include "impostor_cache.hpp"
+#include "node_visitor.hpp"
+#include "render_snapshot.hpp"
+#include "sprite_batch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
 //-------------------------
 //accessors & mutators
 //-------------------------
@@ -57,129 +69,829 @@ Vector2 Node::GetOrigin() {
 	return origin;
 }
 
-Image* Node::GetSprite() {
-	return &sprite;
+std::uint64_t Node::SetKey(std::uint64_t k) {
+	return key = k;
+}
+
+std::uint64_t Node::GetKey() {
+	return key;
+}
+
+int Node::SetBirths(int i) {
+	return births = i;
+}
+
+int Node::GetBirths() {
+	return births;
+}
+
+TextureHandle Node::SetSprite(TextureHandle h) {
+	return sprite = h;
+}
+
+TextureHandle Node::GetSprite() {
+	return sprite;
+}
+
+NodeIndex Node::GetParent() {
+	return parent;
+}
+
+NodeIndex Node::GetFirstChild() {
+	return firstChild;
+}
+
+NodeIndex Node::GetPrevSibling() {
+	return prevSibling;
+}
+
+NodeIndex Node::GetNextSibling() {
+	return nextSibling;
+}
+
+int Node::GetHeight() {
+	return height;
+}
+
+int Node::GetNodeCount() {
+	return nodeCount;
+}
+
+int Node::GetLeafCount() {
+	return leafCount;
+}
+
+BoundingBox Node::GetBounds() {
+	return bounds;
 }
 
-std::list<Node*>* Node::GetChildren() {
-	return &children;
+std::uint64_t Node::GetRevision() {
+	return revision;
 }
 
 //-------------------------
-//public functions
+//NodeTree
 //-------------------------
 
-Node* addChildNode(Node* parent, int direction, int length) {
-	//make, push & setup
-	Node* child = new Node();
-	parent->GetChildren()->push_back(child);
-	child->GetSprite()->SetTexture(parent->GetSprite()->GetTexture());
-	child->SetDirection(direction);
-	child->SetLength(length);
+NodeTree::NodeTree() {
+	//the root node
+	CreateNode();
+	InsertLeaf(0);
+	grid.Insert(0, nodes[0].origin);
+	nodes[0].bounds = BoundingBox(0, 0, 0, 0);
+}
 
-	//cos & sin return radians
-	Vector2 unitVector;
-	unitVector.x = cos(child->GetDirection() * M_PI / 180.0) * 180.0/M_PI;
-	unitVector.y = sin(child->GetDirection() * M_PI / 180.0) * 180.0/M_PI;
+NodeIndex NodeTree::CreateNode() {
+	NodeIndex index = freeList;
 
-	unitVector.Normalize();
+	if (index != NO_NODE) {
+		//recycle a released slot
+		freeList = nodes[index].nextSibling;
+		nodes[index] = Node();
+	}
+	else if (top < nodes.size()) {
+		//reuse a slot from before the last Clear()
+		index = top++;
+		nodes[index] = Node();
+	}
+	else {
+		if (nodes.size() >= NO_NODE) {
+			throw(std::length_error("NodeTree is full"));
+		}
+		if (nodes.size() == nodes.capacity()) {
+			heapAllocations++;
+		}
+		nodes.emplace_back();
+		index = top++;
+	}
 
-	Vector2 v = parent->GetOrigin() + unitVector * child->GetLength();
-	child->SetOrigin(v);
+	slotAllocations++;
+	liveCount++;
+	typeChanges.push_back(index);
+	return index;
+}
 
-	return child;
+void NodeTree::ReleaseNode(NodeIndex index) {
+	MarkDirty(nodes[index].origin);
+	grid.Erase(index);
+	if (nodes[index].leafSlot != NO_NODE) {
+		EraseLeaf(index);
+	}
+	nodes[index].parent = NO_NODE;
+	nodes[index].firstChild = NO_NODE;
+	nodes[index].lastChild = NO_NODE;
+	nodes[index].prevSibling = NO_NODE;
+	nodes[index].nextSibling = freeList;
+	freeList = index;
+	liveCount--;
 }
 
-void drawNodeTree(SDL_Renderer* renderer, Node* root) {
-	if (root == nullptr) {
-		return;
+void NodeTree::AppendChild(NodeIndex parent, NodeIndex child) {
+	Node& p = nodes[parent];
+	Node& c = nodes[child];
+
+	//a former leaf stops counting itself
+	int leafDelta = c.leafCount;
+	if (p.lastChild == NO_NODE) {
+		if (p.leafSlot != NO_NODE) {
+			EraseLeaf(parent);
+		}
+		leafDelta--;
+		p.firstChild = child;
+	}
+	else {
+		nodes[p.lastChild].nextSibling = child;
 	}
+	c.prevSibling = p.lastChild;
+	p.lastChild = child;
+	c.parent = parent;
 
-	int drawX = root->GetOrigin().x - root->GetSprite()->GetClipW() / 2;
-	int drawY = root->GetOrigin().y;
+	if (c.firstChild == NO_NODE && c.leafSlot == NO_NODE) {
+		InsertLeaf(child);
+	}
+
+	UpdateAncestors(parent, child, c.nodeCount, leafDelta);
+	ExpandBounds(parent, c.bounds);
+}
 
-	root->GetSprite()->DrawTo(renderer, drawX, drawY);
+bool NodeTree::DetachNode(NodeIndex index) {
+	Node& c = nodes[index];
+	if (c.parent == NO_NODE) {
+		return false;
+	}
+	NodeIndex parent = c.parent;
+	Node& p = nodes[parent];
 
-	for (auto& it : *root->GetChildren()) {
-		drawNodeTree(renderer, it);
+	//splice the node out of its parent's child list
+	if (c.prevSibling == NO_NODE) {
+		p.firstChild = c.nextSibling;
 	}
+	else {
+		nodes[c.prevSibling].nextSibling = c.nextSibling;
+	}
+	if (c.nextSibling == NO_NODE) {
+		p.lastChild = c.prevSibling;
+	}
+	else {
+		nodes[c.nextSibling].prevSibling = c.prevSibling;
+	}
+	c.parent = NO_NODE;
+	c.prevSibling = NO_NODE;
+	c.nextSibling = NO_NODE;
+
+	//the detached subtree keeps its leaves until it's released
+	int leafDelta = -c.leafCount;
+	if (p.firstChild == NO_NODE) {
+		InsertLeaf(parent);
+		leafDelta++;
+	}
+
+	UpdateAncestors(parent, index, -c.nodeCount, leafDelta);
+	RecomputeBounds(parent);
+	return true;
 }
 
-void destroyTree(Node* root) {
-	for (auto& it : *root->GetChildren()) {
-		destroyTree(it);
+void NodeTree::Clear() {
+	//everything that was drawn needs redrawing
+	dirtyBounds.Expand(nodes[0].bounds);
+
+	//forget everything except where the root is planted & which way it points, the slots are reinitialized on reuse
+	top = 1;
+	freeList = NO_NODE;
+	liveCount = 1;
+	Vector2 origin = nodes[0].origin;
+	int direction = nodes[0].direction;
+	nodes[0] = Node();
+	nodes[0].origin = origin;
+	nodes[0].direction = direction;
+	nodes[0].bounds = BoundingBox(origin.x, origin.y, origin.x, origin.y);
+
+	leaves.clear();
+	InsertLeaf(0);
+	typeChanges.clear();
+	typeChanges.push_back(0);
+	staleOrigins.clear();
+
+	grid.Clear();
+	grid.Insert(0, nodes[0].origin);
+	Touch(0);
+
+	if (journal) {
+		journal->Append({JournalRecord::CLEAR, 0, 0, 0, 0, 0});
 	}
+}
 
-	root->GetChildren()->clear();
-	delete root;
+void NodeTree::Reserve(NodeIndex count) {
+	if (count > nodes.capacity()) {
+		nodes.reserve(count);
+		heapAllocations++;
+	}
 }
 
-//this forces the creation of more nodes
-void generateTree(Node* node, int depth, int spread, int sproutChance) {
-	if (depth < 0) {
-		return;
+void NodeTree::Load(NodeArrays const& arrays) {
+	NodeIndex count = arrays.count;
+	std::uint8_t const* types = arrays.types;
+	std::int32_t const* directions = arrays.directions;
+	std::int32_t const* lengths = arrays.lengths;
+	Vector2 const* origins = arrays.origins;
+	std::uint64_t const* keys = arrays.keys;
+	std::int32_t const* births = arrays.births;
+	std::uint32_t const* ends = arrays.ends;
+
+	if (count == 0) {
+		throw(std::logic_error("No nodes to load"));
+	}
+	if (count >= NO_NODE) {
+		throw(std::runtime_error("Node arrays have too many nodes"));
 	}
-	addChildNode(node, rand() % spread + node->GetDirection() - (spread/2), 10);
 
-	if ((sproutChance == 0 || rand() % sproutChance == 0) && sproutChance != 99) {
-		//wider spread for new shoots
-		addChildNode(node, rand() % (spread*2) + node->GetDirection() - spread, 10);
+	//check every subtree nests inside its parent before touching the tree
+	if (ends[0] != count) {
+		throw(std::runtime_error("Node arrays have a bad root range"));
 	}
+	for (NodeIndex i = 0; i < count; i++) {
+		if (types[i] > Node::Type::FLOWER) {
+			throw(std::runtime_error("Node arrays have a bad node type"));
+		}
+		if (ends[i] <= i || ends[i] > count) {
+			throw(std::runtime_error("Node arrays have a bad child range"));
+		}
+	}
+	for (NodeIndex i = 0; i < count; i++) {
+		for (NodeIndex child = i + 1; child < ends[i]; child = ends[child]) {
+			if (ends[child] > ends[i]) {
+				throw(std::runtime_error("Node arrays have overlapping child ranges"));
+			}
+		}
+	}
+
+	//the journal can't replay this, so it starts again afterwards
+	GrowthJournal* attached = journal;
+	journal = nullptr;
+
+	//after a Clear() the slots are handed out in order, so the arrays' indices are the tree's
+	Clear();
+	Reserve(count);
+	for (NodeIndex i = 1; i < count; i++) {
+		CreateNode();
+	}
+	leaves.clear();
+	grid.Clear();
+	grid.Reserve(count);
+	revision++;
+
+	nodes[0] = Node();
+
+	for (NodeIndex i = 0; i < count; i++) {
+		Node& node = nodes[i];
+		node.type = Node::Type(types[i]);
+		node.direction = directions[i];
+		node.length = lengths[i];
+		node.origin = origins[i];
+		node.key = keys[i];
+		node.births = births[i];
+		node.revision = revision;
+
+		//the children are the runs that tile this node's range
+		NodeIndex prev = NO_NODE;
+		for (NodeIndex child = i + 1; child < ends[i]; child = ends[child]) {
+			nodes[child].parent = i;
+			nodes[child].prevSibling = prev;
+			if (prev == NO_NODE) {
+				node.firstChild = child;
+			}
+			else {
+				nodes[prev].nextSibling = child;
+			}
+			prev = child;
+		}
+		node.lastChild = prev;
+	}
+
+	//children come after their parents, so one backwards pass fills in the cached stats
+	for (NodeIndex i = count; i-- > 0; ) {
+		Node& node = nodes[i];
+		node.nodeCount = ends[i] - i;
+		node.height = 1;
+		node.leafCount = node.firstChild == NO_NODE ? 1 : 0;
+		node.bounds = BoundingBox(node.origin.x, node.origin.y, node.origin.x, node.origin.y);
+
+		for (NodeIndex child = node.firstChild; child != NO_NODE; child = nodes[child].nextSibling) {
+			Node& c = nodes[child];
+			node.height = std::max(node.height, c.height + 1);
+			node.leafCount += c.leafCount;
+			node.bounds.Expand(c.bounds);
+		}
+	}
+
+	for (NodeIndex i = 0; i < count; i++) {
+		if (nodes[i].firstChild == NO_NODE) {
+			InsertLeaf(i);
+		}
+		grid.Insert(i, nodes[i].origin);
+	}
+
+	dirtyBounds.Expand(nodes[0].bounds);
 
-	for (auto& it : *node->GetChildren()) {
-		generateTree(it, depth - 1, spread, sproutChance);
+	if (attached) {
+		attached->Start(this);
 	}
 }
 
-//this finds the end points of the tree, ignoring types
-void findLeaves(Node* root, std::list<Node*>* leafList) {
-	if (root->GetChildren()->size() == 0) {
-		leafList->push_back(root);
+Node* NodeTree::GetNode(NodeIndex index) {
+	return &nodes[index];
+}
+
+NodeIndex NodeTree::GetIndex(Node* node) {
+	return node - nodes.data();
+}
+
+NodeIndex NodeTree::GetRoot() {
+	return 0;
+}
+
+int NodeTree::Size() {
+	return liveCount;
+}
+
+Vector2 NodeTree::PlaceNode(NodeIndex index, Vector2 origin) {
+	grid.Insert(index, origin);
+	MarkDirty(origin);
+
+	//a new node can only grow its ancestors' bounds, a moved one might shrink them
+	Node& node = nodes[index];
+	bool placed = !node.bounds.Empty();
+	if (placed) {
+		//it's drawn where it was until the next redraw
+		MarkDirty(node.origin);
+	}
+	node.origin = origin;
+	if (placed) {
+		RecomputeBounds(index);
+
+		//the children are measured from here
+		for (NodeIndex child = node.firstChild; child != NO_NODE; child = nodes[child].nextSibling) {
+			staleOrigins.push_back(child);
+		}
 	}
 	else {
-		for (auto& it : *root->GetChildren()) {
-			findLeaves(it, leafList);
+		node.bounds = BoundingBox(origin.x, origin.y, origin.x, origin.y);
+		if (node.parent != NO_NODE) {
+			ExpandBounds(node.parent, node.bounds);
 		}
 	}
+
+	Touch(index);
+
+	//new nodes are recorded by addChildNode()
+	if (journal && placed) {
+		journal->AppendPlace(index, origin);
+	}
+	return origin;
+}
+
+SpatialGrid* NodeTree::GetGrid() {
+	return &grid;
 }
 
-//apply the given function to all nodes
-void forEachNode(Node* root, std::function<int(Node*)> fn) {
-	fn(root);
-	for (auto& it : *root->GetChildren()) {
-		forEachNode(it, fn);
+int NodeTree::SetDirection(NodeIndex index, int direction) {
+	if (nodes[index].direction == direction) {
+		return direction;
 	}
+
+	staleOrigins.push_back(index);
+	nodes[index].direction = direction;
+	if (journal) {
+		journal->Append({JournalRecord::SET_DIRECTION, 0, 0, index, direction, 0});
+	}
+	return direction;
 }
 
+int NodeTree::SetLength(NodeIndex index, int length) {
+	if (nodes[index].length == length) {
+		return length;
+	}
+
+	staleOrigins.push_back(index);
+	nodes[index].length = length;
+	if (journal) {
+		journal->Append({JournalRecord::SET_LENGTH, 0, 0, index, length, 0});
+	}
+	return length;
+}
 
-int countEachNode(Node* node) {
-	int count = 0;
-	forEachNode(node, [&count](Node* node) -> int {
-		count++;
+int NodeTree::UpdateOrigins() {
+	if (staleOrigins.empty()) {
 		return 0;
+	}
+
+	//the root and released nodes have no parent to follow, and a stale node inside another's subtree gets recomputed with it
+	staleOrigins.erase(std::remove_if(staleOrigins.begin(), staleOrigins.end(), [this](NodeIndex index) {
+		return nodes[index].parent == NO_NODE;
+	}), staleOrigins.end());
+	std::sort(staleOrigins.begin(), staleOrigins.end());
+	staleOrigins.erase(std::unique(staleOrigins.begin(), staleOrigins.end()), staleOrigins.end());
+	auto covered = [this](NodeIndex index) -> bool {
+		for (NodeIndex it = nodes[index].parent; it != NO_NODE; it = nodes[it].parent) {
+			if (std::binary_search(staleOrigins.begin(), staleOrigins.end(), it)) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	//the highest stale nodes
+	std::vector<NodeIndex>& slots = transformNodes;
+	for (auto& it : staleOrigins) {
+		if (!covered(it)) {
+			slots.push_back(it);
+		}
+	}
+	int anchors = slots.size();
+
+	//their parents are the anchors, then come the stale nodes and everything below them a level at a time
+	for (int slot = 0; slot < anchors; slot++) {
+		transforms.AddAnchor(nodes[nodes[slots[slot]].parent].origin);
+	}
+	if (anchors > 0) {
+		transforms.NextLevel();
+		for (int slot = 0; slot < anchors; slot++) {
+			NodeIndex stale = slots[slot];
+			transforms.AddNode(slot, nodes[stale].direction, nodes[stale].length);
+			slots.push_back(stale);
+			slots[slot] = nodes[stale].parent;
+		}
+	}
+	for (int begin = anchors, end = slots.size(); begin < end; begin = end, end = slots.size()) {
+		transforms.NextLevel();
+		for (int slot = begin; slot < end; slot++) {
+			for (NodeIndex child = nodes[slots[slot]].firstChild; child != NO_NODE; child = nodes[child].nextSibling) {
+				transforms.AddNode(slot, nodes[child].direction, nodes[child].length);
+				slots.push_back(child);
+			}
+		}
+	}
+
+	transforms.Run();
+
+	//only the nodes that actually moved go back to the grid, (the stale list is done with, so it collects them)
+	staleOrigins.clear();
+	revision++;
+	for (int slot = anchors; slot < int(slots.size()); slot++) {
+		Node& node = nodes[slots[slot]];
+		Vector2 origin = transforms.GetOrigin(slot);
+		if (origin != node.origin) {
+			MarkDirty(node.origin);
+			MarkDirty(origin);
+			node.origin = origin;
+			staleOrigins.push_back(slots[slot]);
+		}
+		node.bounds = BoundingBox(origin.x, origin.y, origin.x, origin.y);
+		node.revision = revision;
+	}
+	grid.MoveMany(staleOrigins.data(), staleOrigins.size(), [this](int i) {
+		return nodes[staleOrigins[i]].origin;
 	});
+
+	//children come after their parents, so a backwards pass rebuilds the bounds
+	for (int slot = slots.size() - 1; slot >= anchors; slot--) {
+		int parent = transforms.GetParent(slot);
+		if (parent >= anchors) {
+			nodes[slots[parent]].bounds.Expand(nodes[slots[slot]].bounds);
+		}
+	}
+
+	//and the anchors pass them on to their ancestors
+	for (int slot = 0; slot < anchors; slot++) {
+		RecomputeBounds(slots[slot]);
+		for (NodeIndex it = slots[slot]; it != NO_NODE && nodes[it].revision != revision; it = nodes[it].parent) {
+			nodes[it].revision = revision;
+		}
+	}
+
+	int count = slots.size() - anchors;
+	staleOrigins.clear();
+	transforms.Clear();
+	slots.clear();
+
+	if (journal && count > 0) {
+		journal->Append({JournalRecord::UPDATE_ORIGINS, 0, 0, 0, 0, 0});
+	}
 	return count;
 }
 
+Node::Type NodeTree::SetType(NodeIndex index, Node::Type type) {
+	if (nodes[index].type == type) {
+		return type;
+	}
+
+	typeChanges.push_back(index);
+	nodes[index].type = type;
+	if (journal) {
+		journal->Append({JournalRecord::SET_TYPE, std::uint8_t(type), 0, index, 0, 0});
+	}
+	return type;
+}
+
+std::vector<NodeIndex> const& NodeTree::GetTypeChanges() {
+	return typeChanges;
+}
+
+void NodeTree::ClearTypeChanges() {
+	typeChanges.clear();
+}
 
-int findDeepestLeaf(Node* node) {
-	if (node->GetChildren()->size() == 0) {
-		return 1;
+void NodeTree::Touch(NodeIndex index) {
+	revision++;
+	for (NodeIndex it = index; it != NO_NODE; it = nodes[it].parent) {
+		nodes[it].revision = revision;
 	}
+}
+
+void NodeTree::MarkDirty(Vector2 v) {
+	dirtyBounds.Expand(v);
+}
+
+BoundingBox NodeTree::GetDirtyBounds() {
+	return dirtyBounds;
+}
 
-	std::list<int> depthList;
+void NodeTree::ClearDirtyBounds() {
+	dirtyBounds = BoundingBox::Nothing();
+}
 
-	for (auto& it : *node->GetChildren()) {
-		depthList.push_back(findDeepestLeaf(it));
+std::uint64_t NodeTree::SetSeed(std::uint64_t s) {
+	seed = s;
+	if (journal) {
+		journal->Append({JournalRecord::SET_SEED, 0, 0, 0, std::int32_t(s), std::int32_t(s >> 32)});
 	}
+	return seed;
+}
+
+std::uint64_t NodeTree::GetSeed() {
+	return seed;
+}
+
+GrowthJournal* NodeTree::SetJournal(GrowthJournal* j) {
+	return journal = j;
+}
+
+GrowthJournal* NodeTree::GetJournal() {
+	return journal;
+}
+
+std::vector<NodeIndex> const& NodeTree::GetLeaves() {
+	return leaves;
+}
+
+int NodeTree::GetLeafCount() {
+	return leaves.size();
+}
 
-	int deepest = 0;
+int NodeTree::GetCapacity() {
+	return nodes.capacity();
+}
 
-	for (auto& it : depthList) {
-		if (it > deepest) {
-			deepest = it;
+int NodeTree::GetSlotAllocations() {
+	return slotAllocations;
+}
+
+int NodeTree::GetHeapAllocations() {
+	return heapAllocations;
+}
+
+void NodeTree::InsertLeaf(NodeIndex index) {
+	if (leaves.size() == leaves.capacity()) {
+		heapAllocations++;
+	}
+	nodes[index].leafSlot = leaves.size();
+	leaves.push_back(index);
+}
+
+void NodeTree::EraseLeaf(NodeIndex index) {
+	//swap the last leaf into the vacated slot
+	NodeIndex slot = nodes[index].leafSlot;
+	NodeIndex last = leaves.back();
+	leaves[slot] = last;
+	nodes[last].leafSlot = slot;
+	leaves.pop_back();
+	nodes[index].leafSlot = NO_NODE;
+}
+
+void NodeTree::UpdateAncestors(NodeIndex index, NodeIndex child, int nodeDelta, int leafDelta) {
+	//the counts and revision change all the way up, the height only until it settles
+	bool heightChanged = true;
+	revision++;
+	for (NodeIndex it = index; it != NO_NODE; child = it, it = nodes[it].parent) {
+		Node& node = nodes[it];
+		node.nodeCount += nodeDelta;
+		node.leafCount += leafDelta;
+		node.revision = revision;
+
+		if (!heightChanged) {
+			continue;
+		}
+
+		int height = node.height;
+		if (nodeDelta > 0) {
+			//growing can only raise the height
+			if (nodes[child].height + 1 > height) {
+				height = nodes[child].height + 1;
+			}
+		}
+		else {
+			//shrinking needs the tallest remaining child
+			height = 0;
+			for (NodeIndex sibling = node.firstChild; sibling != NO_NODE; sibling = nodes[sibling].nextSibling) {
+				if (nodes[sibling].height > height) {
+					height = nodes[sibling].height;
+				}
+			}
+			height++;
 		}
+
+		heightChanged = node.height != height;
+		node.height = height;
+	}
+}
+
+void NodeTree::ExpandBounds(NodeIndex index, BoundingBox const& box) {
+	//stop at the first ancestor that already covers it
+	for (NodeIndex it = index; it != NO_NODE && !nodes[it].bounds.Contains(box); it = nodes[it].parent) {
+		nodes[it].bounds.Expand(box);
 	}
+}
+
+void NodeTree::RecomputeBounds(NodeIndex index) {
+	//rebuild from the children, until an ancestor doesn't change
+	for (NodeIndex it = index; it != NO_NODE; it = nodes[it].parent) {
+		Node& node = nodes[it];
+		BoundingBox bounds(node.origin.x, node.origin.y, node.origin.x, node.origin.y);
+		for (NodeIndex child = node.firstChild; child != NO_NODE; child = nodes[child].nextSibling) {
+			bounds.Expand(nodes[child].bounds);
+		}
+
+		if (bounds.Contains(node.bounds) && node.bounds.Contains(bounds)) {
+			return;
+		}
+		node.bounds = bounds;
+	}
+}
+
+//-------------------------
+//public functions
+//-------------------------
+
+NodeIndex addChildNode(NodeTree* tree, NodeIndex parent, int direction, int length) {
+	//make, push & setup (this can move the parent)
+	NodeIndex index = tree->CreateNode();
+	tree->AppendChild(parent, index);
+
+	Node* child = tree->GetNode(index);
+	child->SetSprite(tree->GetNode(parent)->GetSprite());
+	child->SetDirection(direction);
+	child->SetLength(length);
+
+	//the child's identity depends only on its ancestry
+	Node* p = tree->GetNode(parent);
+	child->SetKey(BranchRandom::ChildKey(p->GetKey(), p->GetBirths()));
+	p->SetBirths(p->GetBirths() + 1);
+
+	Vector2 v = tree->GetNode(parent)->GetOrigin() + directionTable[child->GetDirection()] * child->GetLength();
+	tree->PlaceNode(index, v);
+
+	//the parent's sprite might change too
+	tree->MarkDirty(tree->GetNode(parent)->GetOrigin());
+
+	if (GrowthJournal* journal = tree->GetJournal()) {
+		journal->Append({JournalRecord::ADD_CHILD, 0, 0, parent, direction, length});
+	}
+	return index;
+}
+
+//padding is how far a sprite can reach past its node's origin, in world units
+//subtrees that are small on screen are drawn as impostors, if there's a cache for them
+void drawNodeTree(SpriteBatch* batch, NodeTree* tree, NodeIndex root, Camera const& camera, int padding, ImpostorCache* impostors) {
+	if (root == NO_NODE) {
+		return;
+	}
+
+	BoundingBox view = camera.GetView();
+	view = {view.minX - padding, view.minY - padding, view.maxX + padding, view.maxY + padding};
+	float zoom = camera.GetZoom();
+	TextureLoader& textures = TextureLoader::GetSingleton();
+
+	forEachNode(tree, root, [batch, tree, &camera, padding, impostors, &view, zoom, &textures](Node* node) -> int {
+		if (!view.Intersects(node->GetBounds())) {
+			return Visit::SKIP_CHILDREN;
+		}
+		if (impostors && impostors->Draw(batch, tree, tree->GetIndex(node), camera, padding)) {
+			return Visit::SKIP_CHILDREN;
+		}
+		if (!view.Contains(node->GetOrigin())) {
+			return Visit::CONTINUE;
+		}
+
+		Image* sprite = textures.GetImage(node->GetSprite());
+		if (!sprite) {
+			return Visit::CONTINUE;
+		}
+		Vector2 draw = camera.WorldToScreen({node->GetOrigin().x - sprite->GetClipW() / 2, node->GetOrigin().y});
+
+		batch->Draw(sprite->GetTexture(), sprite->GetClip(), draw.x, draw.y, sprite->GetClipW() * zoom, sprite->GetClipH() * zoom);
+		return Visit::CONTINUE;
+	});
+}
+
+void snapshotNodeTree(RenderSnapshot* snapshot, NodeTree* tree, NodeIndex root, Camera const& camera, int padding) {
+	if (root == NO_NODE) {
+		return;
+	}
+
+	BoundingBox view = camera.GetView();
+	view = {view.minX - padding, view.minY - padding, view.maxX + padding, view.maxY + padding};
+
+	//the handles are resolved by whoever draws the snapshot
+	forEachNode(tree, root, [snapshot, &camera, &view](Node* node) -> int {
+		if (!view.Intersects(node->GetBounds())) {
+			return Visit::SKIP_CHILDREN;
+		}
+		if (!view.Contains(node->GetOrigin()) || node->GetSprite() == NO_TEXTURE) {
+			return Visit::CONTINUE;
+		}
+
+		Vector2 anchor = camera.WorldToScreen(node->GetOrigin());
+		snapshot->sprites.push_back({node->GetSprite(), float(anchor.x), float(anchor.y)});
+		return Visit::CONTINUE;
+	});
+}
+
+void destroyTree(NodeTree* tree, NodeIndex root) {
+	//nothing can reach the subtree while it's being released
+	tree->DetachNode(root);
+
+	forEachNodePostOrder(tree, root, [tree](Node* node) -> int {
+		tree->ReleaseNode(tree->GetIndex(node));
+		return Visit::CONTINUE;
+	});
+
+	if (GrowthJournal* journal = tree->GetJournal()) {
+		journal->Append({JournalRecord::PRUNE, 0, 0, root, 0, 0});
+	}
+}
+
+//this forces the creation of more nodes
+void generateTree(NodeTree* tree, NodeIndex node, int depth, int spread, int sproutChance, int length) {
+	if (depth < 0) {
+		return;
+	}
+
+	Sprout sprouts[2];
+	int count = sproutBranch(tree, node, spread, sproutChance, length, sprouts);
+	for (int i = 0; i < count; i++) {
+		addChildNode(tree, node, sprouts[i].direction, sprouts[i].length);
+	}
+
+	for (NodeIndex it = tree->GetNode(node)->GetFirstChild(); it != NO_NODE; it = tree->GetNode(it)->GetNextSibling()) {
+		generateTree(tree, it, depth - 1, spread, sproutChance, length);
+	}
+}
+
+//this decides one level of growth without touching the tree, (writes up to 2 sprouts)
+//a branch forks 1 in sproutChance times, so 1 always forks and 0 never does
+int sproutBranch(NodeTree* tree, NodeIndex node, int spread, int sproutChance, int length, Sprout* sprouts) {
+	//each growth of a branch gets its own stream
+	Node* n = tree->GetNode(node);
+	BranchRandom rng(tree->GetSeed(), n->GetKey(), n->GetBirths());
+	std::uint32_t rolls[3];
+	rng.Fill(rolls, 3);
+
+	int count = 0;
+	sprouts[count++] = {node, int(rolls[0] % spread) + n->GetDirection() - (spread/2), length, Node::Type::LEAF};
+
+	if (sproutChance != 0 && rolls[1] % sproutChance == 0) {
+		//wider spread for new shoots
+		sprouts[count++] = {node, int(rolls[2] % (spread*2)) + n->GetDirection() - spread, length, Node::Type::LEAF};
+	}
+
+	return count;
+}
+
+//this finds the end points of the tree, ignoring types
+void findLeaves(NodeTree* tree, NodeIndex root, std::vector<NodeIndex>* leafList) {
+	forEachNode(tree, root, [tree, leafList](Node* node) -> int {
+		if (node->GetFirstChild() == NO_NODE) {
+			leafList->push_back(tree->GetIndex(node));
+		}
+		return Visit::CONTINUE;
+	});
+}
+
+int countEachNode(NodeTree* tree, NodeIndex node) {
+	return tree->GetNode(node)->GetNodeCount();
+}
+
 
-	return deepest + 1;
+int findDeepestLeaf(NodeTree* tree, NodeIndex node) {
+	return tree->GetNode(node)->GetHeight();
 }
@@ -21,14 +21,36 @@
 */
 #pragma once
 
-#include "image.hpp"
+#include "bounding_box.hpp"
+#include "branch_random.hpp"
+#include "spatial_grid.hpp"
+#include "texture_loader.hpp"
+#include "transform_pass.hpp"
 #include "vector2.hpp"
 
 #include "SDL2/SDL.h"
 
-#include <cmath>
-#include <functional>
-#include <list>
+#include <cstdint>
+#include <vector>
+
+class Camera;
+class GrowthJournal;
+class ImpostorCache;
+class SpriteBatch;
+struct RenderSnapshot;
+
+//DOCS: NodeArrays is a whole tree as one flat array per field, with the nodes in depth first order
+//DOCS: node i's subtree is [i, ends[i]), so its first child is i + 1 and each child's end is the next one's index
+struct NodeArrays {
+	NodeIndex count = 0;
+	std::uint8_t const* types = nullptr; //Node::Type
+	std::int32_t const* directions = nullptr;
+	std::int32_t const* lengths = nullptr;
+	Vector2 const* origins = nullptr;
+	std::uint64_t const* keys = nullptr;
+	std::int32_t const* births = nullptr;
+	std::uint32_t const* ends = nullptr;
+};
 
 class Node {
 public:
@@ -42,9 +64,9 @@ public:
 	~Node() = default;
 
 	//accessors & mutators
-	Type SetType(Type t);
+	Type SetType(Type t); //NodeTree::SetType() records the change too
 	Type GetType();
-	int SetDirection(int i);
+	int SetDirection(int i); //NodeTree::SetDirection() & SetLength() move the subtree too
 	int GetDirection();
 	int SetLength(int i);
 	int GetLength();
@@ -52,26 +74,200 @@ public:
 	Vector2 SetOrigin(Vector2 v);
 	Vector2 GetOrigin();
 
-	Image* GetSprite();
-	std::list<Node*>* GetChildren();
+	//identity for the branch random streams
+	std::uint64_t SetKey(std::uint64_t k);
+	std::uint64_t GetKey();
+	int SetBirths(int i);
+	int GetBirths();
+
+	TextureHandle SetSprite(TextureHandle h);
+	TextureHandle GetSprite();
+
+	//links
+	NodeIndex GetParent();
+	NodeIndex GetFirstChild();
+	NodeIndex GetPrevSibling();
+	NodeIndex GetNextSibling();
+
+	//cached subtree stats, including this node
+	int GetHeight();
+	int GetNodeCount();
+	int GetLeafCount();
+	BoundingBox GetBounds(); //the origins in this subtree
+	std::uint64_t GetRevision(); //changes whenever this subtree does
 
 private:
+	friend class NodeTree;
+
 	Type type = Type::LEAF;
 	//right = 0, down = 90, left = 180, up = 270
 	int direction = 0;
 	int length = 0;
-	Vector2 origin; //cached position for drawing
-	Image sprite;
-	std::list<Node*> children;
+	Vector2 origin; //the parent's origin + direction * length, except for the root
+	std::uint64_t key = 0;
+	int births = 0; //children ever created here, including pruned ones
+	TextureHandle sprite = NO_TEXTURE;
+
+	//first-child/next-sibling links into the NodeTree
+	NodeIndex parent = NO_NODE;
+	NodeIndex firstChild = NO_NODE;
+	NodeIndex lastChild = NO_NODE;
+	NodeIndex prevSibling = NO_NODE;
+	NodeIndex nextSibling = NO_NODE;
+
+	//position in the NodeTree's leaf set
+	NodeIndex leafSlot = NO_NODE;
+
+	//maintained by the NodeTree along the parent path
+	int height = 1;
+	int nodeCount = 1;
+	int leafCount = 1;
+	BoundingBox bounds = BoundingBox::Nothing(); //empty until placed
+	std::uint64_t revision = 0;
+};
+
+//DOCS: NodeTree keeps every node in one contiguous buffer, the root lives in slot 0
+//DOCS: released slots are recycled through a free list, and Clear() is O(1)
+//DOCS: the tree tracks its childless nodes as they're linked, unlinked and released
+//DOCS: nodes know their parent and both siblings, so detaching a subtree is O(1) plus the ancestor updates
+//DOCS: linking, unlinking and placing also refresh the cached stats and bounds of every ancestor
+//DOCS: and stamp them with a new revision, which is never reused
+//DOCS: placed nodes are indexed by origin in a SpatialGrid until they're released
+//DOCS: moving a node or changing its heading leaves the origins below it stale until UpdateOrigins()
+//NOTE: Node pointers are invalidated by CreateNode(), hold onto indices instead
+class NodeTree {
+public:
+	NodeTree();
+	~NodeTree() = default;
+
+	NodeIndex CreateNode();
+	void ReleaseNode(NodeIndex index);
+	void AppendChild(NodeIndex parent, NodeIndex child);
+	bool DetachNode(NodeIndex index);
+	void Clear(); //the root starts over too, except for its origin & direction
+	void Reserve(NodeIndex count);
+
+	//replaces every node at once, bad arrays throw before anything changes
+	//an attached journal starts over from the loaded tree
+	void Load(NodeArrays const& arrays);
+
+	Node* GetNode(NodeIndex index);
+	NodeIndex GetIndex(Node* node);
+	NodeIndex GetRoot();
+	int Size();
+
+	//sets the origin and keeps the spatial index up to date, the nodes below follow on the next UpdateOrigins()
+	Vector2 PlaceNode(NodeIndex index, Vector2 origin);
+
+	//these recompute the subtree's origins on the next UpdateOrigins()
+	int SetDirection(NodeIndex index, int direction);
+	int SetLength(NodeIndex index, int length);
+
+	//recomputes every origin below the nodes moved or turned since the last call, returns how many
+	int UpdateOrigins();
+	SpatialGrid* GetGrid();
+
+	//for changes the tree can't see, like a node's sprite
+	void Touch(NodeIndex index);
+
+	//the nodes created or retyped since the last ClearTypeChanges(), they can repeat or be released since
+	Node::Type SetType(NodeIndex index, Node::Type type);
+	std::vector<NodeIndex> const& GetTypeChanges();
+	void ClearTypeChanges();
+
+	//the area around the nodes added or released since the last ClearDirtyBounds()
+	void MarkDirty(Vector2 v);
+	BoundingBox GetDirtyBounds();
+	void ClearDirtyBounds();
+
+	//every random draw made while growing derives from this
+	std::uint64_t SetSeed(std::uint64_t s);
+	std::uint64_t GetSeed();
+
+	//records the changes to this tree, or nullptr
+	GrowthJournal* SetJournal(GrowthJournal* j);
+	GrowthJournal* GetJournal();
+
+	//the current childless nodes, in no particular order
+	std::vector<NodeIndex> const& GetLeaves();
+	int GetLeafCount();
+
+	//allocation counters
+	int GetCapacity();
+	int GetSlotAllocations();
+	int GetHeapAllocations();
+
+private:
+	void InsertLeaf(NodeIndex index);
+	void EraseLeaf(NodeIndex index);
+	void UpdateAncestors(NodeIndex index, NodeIndex child, int nodeDelta, int leafDelta);
+	void ExpandBounds(NodeIndex index, BoundingBox const& box);
+	void RecomputeBounds(NodeIndex index);
+
+	std::vector<Node> nodes;
+	std::vector<NodeIndex> leaves;
+	std::vector<NodeIndex> typeChanges;
+	std::vector<NodeIndex> staleOrigins; //nodes whose origins no longer follow from their parent's
+	NodeIndex top = 0; //slots handed out since the last Clear()
+	NodeIndex freeList = NO_NODE; //threaded through nextSibling
+	int liveCount = 0;
+	std::uint64_t seed = 0;
+	std::uint64_t revision = 0;
+	BoundingBox dirtyBounds = BoundingBox::Nothing();
+	SpatialGrid grid;
+	GrowthJournal* journal = nullptr;
+
+	//scratch space for UpdateOrigins(), empty between calls
+	TransformPass transforms;
+	std::vector<NodeIndex> transformNodes; //by slot
+
+	int slotAllocations = 0;
+	int heapAllocations = 0;
+};
+
+//a child waiting to be linked into the tree
+struct Sprout {
+	NodeIndex parent;
+	int direction;
+	int length;
+	Node::Type type;
 };
 
 //public functions
-Node* addChildNode(Node* parent, int direction, int length);
-void drawNodeTree(SDL_Renderer*, Node* root);
-void destroyTree(Node* root);
-
-void generateTree(Node* node, int depth, int spread, int sproutChance);
-void findLeaves(Node* root, std::list<Node*>* leafList);
-void forEachNode(Node* root, std::function<int(Node*)> fn);
-int countEachNode(Node* node);
-int findDeepestLeaf(Node* node);
+NodeIndex addChildNode(NodeTree* tree, NodeIndex parent, int direction, int length);
+void drawNodeTree(SpriteBatch* batch, NodeTree* tree, NodeIndex root, Camera const& camera, int padding, ImpostorCache* impostors = nullptr);
+void snapshotNodeTree(RenderSnapshot* snapshot, NodeTree* tree, NodeIndex root, Camera const& camera, int padding); //the same sprites, without touching the textures
+void destroyTree(NodeTree* tree, NodeIndex root);
+
+//a branch forks 1 in sproutChance times, so 1 always forks and 0 never does, (it used to be 0 for always and 99 for never)
+void generateTree(NodeTree* tree, NodeIndex node, int depth, int spread, int sproutChance, int length);
+int sproutBranch(NodeTree* tree, NodeIndex node, int spread, int sproutChance, int length, Sprout* sprouts);
+
+template<int spread, int sproutChance, int length>
+int sproutBranch(NodeTree* tree, NodeIndex node, Sprout* sprouts);
+void findLeaves(NodeTree* tree, NodeIndex root, std::vector<NodeIndex>* leafList);
+int countEachNode(NodeTree* tree, NodeIndex node);
+int findDeepestLeaf(NodeTree* tree, NodeIndex node);
+
+//the same rolls as sproutBranch(), with the parameters folded in
+template<int spread, int sproutChance, int length>
+int sproutBranch(NodeTree* tree, NodeIndex node, Sprout* sprouts) {
+	static_assert(spread > 0 && sproutChance >= 0 && length > 0, "Bad sprout parameters");
+
+	Node* n = tree->GetNode(node);
+	BranchRandom rng(tree->GetSeed(), n->GetKey(), n->GetBirths());
+	std::uint32_t rolls[3];
+	rng.Fill(rolls, 3);
+
+	int count = 0;
+	sprouts[count++] = {node, int(rolls[0] % spread) + n->GetDirection() - (spread/2), length, Node::Type::LEAF};
+
+	if constexpr (sproutChance != 0) {
+		if (sproutChance == 1 || rolls[1] % sproutChance == 0) {
+			//wider spread for new shoots
+			sprouts[count++] = {node, int(rolls[2] % (spread*2)) + n->GetDirection() - spread, length, Node::Type::LEAF};
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,130 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "node.hpp"
+
+#include <vector>
+
+//return values for the visitor callbacks
+struct Visit {
+	enum Result {
+		CONTINUE = 0,
+		SKIP_CHILDREN,
+		STOP
+	};
+};
+
+//DOCS: The visitors walk the parent & sibling links rather than the call stack, so depth isn't limited
+//DOCS: Callbacks take a Node* and return a Visit::Result (or an int), they may release the node they're given in post-order
+
+//parents before children
+template<typename Fn>
+void forEachNode(NodeTree* tree, NodeIndex root, Fn fn) {
+	NodeIndex it = root;
+	while (it != NO_NODE) {
+		int result = fn(tree->GetNode(it));
+		if (result == Visit::STOP) {
+			return;
+		}
+
+		//descend
+		Node* node = tree->GetNode(it);
+		if (result != Visit::SKIP_CHILDREN && node->GetFirstChild() != NO_NODE) {
+			it = node->GetFirstChild();
+			continue;
+		}
+
+		//climb until there's a sibling to move to
+		while (it != root && tree->GetNode(it)->GetNextSibling() == NO_NODE) {
+			it = tree->GetNode(it)->GetParent();
+		}
+		it = it == root ? NO_NODE : tree->GetNode(it)->GetNextSibling();
+	}
+}
+
+//parents before children, only the nodes inside the box
+//whole subtrees are skipped when their cached bounds miss it
+template<typename Fn>
+void forEachNodeInBox(NodeTree* tree, NodeIndex root, BoundingBox const& box, Fn fn) {
+	forEachNode(tree, root, [&](Node* node) -> int {
+		if (!box.Intersects(node->GetBounds())) {
+			return Visit::SKIP_CHILDREN;
+		}
+		if (!box.Contains(node->GetOrigin())) {
+			return Visit::CONTINUE;
+		}
+		return fn(node);
+	});
+}
+
+//children before parents
+template<typename Fn>
+void forEachNodePostOrder(NodeTree* tree, NodeIndex root, Fn fn) {
+	NodeIndex it = root;
+	while (tree->GetNode(it)->GetFirstChild() != NO_NODE) {
+		it = tree->GetNode(it)->GetFirstChild();
+	}
+
+	while (it != NO_NODE) {
+		//find the next node before the callback can touch this one
+		Node* node = tree->GetNode(it);
+		NodeIndex next = NO_NODE;
+		if (it != root) {
+			next = node->GetNextSibling();
+			if (next == NO_NODE) {
+				next = node->GetParent();
+			}
+			else {
+				while (tree->GetNode(next)->GetFirstChild() != NO_NODE) {
+					next = tree->GetNode(next)->GetFirstChild();
+				}
+			}
+		}
+
+		if (fn(node) == Visit::STOP) {
+			return;
+		}
+		it = next;
+	}
+}
+
+//level by level
+template<typename Fn>
+void forEachNodeBreadthFirst(NodeTree* tree, NodeIndex root, Fn fn) {
+	std::vector<NodeIndex> queue;
+	queue.push_back(root);
+
+	for (std::size_t head = 0; head < queue.size(); head++) {
+		int result = fn(tree->GetNode(queue[head]));
+		if (result == Visit::STOP) {
+			return;
+		}
+		if (result == Visit::SKIP_CHILDREN) {
+			continue;
+		}
+
+		for (NodeIndex child = tree->GetNode(queue[head])->GetFirstChild(); child != NO_NODE; child = tree->GetNode(child)->GetNextSibling()) {
+			queue.push_back(child);
+		}
+	}
+}
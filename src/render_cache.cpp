@@ -0,0 +1,82 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "render_cache.hpp"
+
+void RenderCache::Invalidate() {
+	dirtyAll = true;
+}
+
+void RenderCache::Invalidate(SDL_Rect const& region) {
+	if (dirty) {
+		SDL_UnionRect(&dirtyRegion, &region, &dirtyRegion);
+	}
+	else {
+		dirtyRegion = region;
+		dirty = true;
+	}
+}
+
+void RenderCache::DrawTo(SDL_Renderer* renderer, std::function<void(SDL_Renderer*)> const& redraw) {
+	//match the logical screen
+	int w = 0, h = 0;
+	SDL_RenderGetLogicalSize(renderer, &w, &h);
+	if (w == 0 || h == 0) {
+		SDL_GetRendererOutputSize(renderer, &w, &h);
+	}
+
+	if (!target.GetTexture() || target.GetClipW() != w || target.GetClipH() != h) {
+		target.Create(renderer, w, h, {0, 0, 0, 0});
+		SDL_SetTextureBlendMode(target.GetTexture(), SDL_BLENDMODE_BLEND);
+		dirtyAll = true;
+	}
+
+	//a dirty region that's entirely off screen has nothing to redraw
+	SDL_Rect full = {0, 0, w, h};
+	SDL_Rect region = full;
+	if (dirty && !dirtyAll && !SDL_IntersectRect(&dirtyRegion, &full, &region)) {
+		dirty = false;
+	}
+
+	if (dirtyAll || dirty) {
+		//wipe the region back to transparent, then redraw over it
+		SDL_SetRenderTarget(renderer, target.GetTexture());
+		SDL_RenderSetClipRect(renderer, &region);
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+		SDL_RenderFillRect(renderer, &region);
+
+		redraw(renderer);
+
+		SDL_RenderSetClipRect(renderer, nullptr);
+		SDL_SetRenderTarget(renderer, nullptr);
+
+		dirtyAll = false;
+		dirty = false;
+		redrawCount++;
+	}
+
+	target.DrawTo(renderer, 0, 0);
+}
+
+int RenderCache::GetRedrawCount() {
+	return redrawCount;
+}
@@ -0,0 +1,52 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "image.hpp"
+
+#include "SDL2/SDL.h"
+
+#include <functional>
+
+//DOCS: RenderCache keeps a drawing in a target texture, and only redraws the regions invalidated since the last frame
+//DOCS: An unchanged frame costs one texture copy
+class RenderCache {
+public:
+	RenderCache() = default;
+	~RenderCache() = default;
+
+	void Invalidate();
+	void Invalidate(SDL_Rect const& region);
+
+	//redraw() is called with the renderer targeting the cache, clipped to the dirty region
+	void DrawTo(SDL_Renderer* renderer, std::function<void(SDL_Renderer*)> const& redraw);
+
+	//stats
+	int GetRedrawCount();
+
+private:
+	Image target;
+	bool dirtyAll = true;
+	bool dirty = false;
+	SDL_Rect dirtyRegion = {0, 0, 0, 0};
+	int redrawCount = 0;
+};
@@ -0,0 +1,41 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "texture_loader.hpp"
+
+#include <vector>
+
+//DOCS: RenderSnapshot is a finished picture of a scene, written by the simulation thread and drawn by the render thread
+//DOCS: it only holds texture handles & screen positions, the render thread looks the textures up, (the TextureLoader isn't thread safe)
+//DOCS: it's never changed after being published, (see TripleBuffer)
+struct RenderSnapshot {
+	//anchored at the middle of the image's top edge, and scaled by the zoom
+	struct Sprite {
+		TextureHandle handle;
+		float x;
+		float y;
+	};
+
+	std::vector<Sprite> sprites;
+	float zoom = 1;
+};
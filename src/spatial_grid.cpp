@@ -0,0 +1,169 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "spatial_grid.hpp"
+
+#include <cmath>
+
+SpatialGrid::SpatialGrid(double size): cellSize(size) {
+	buckets.resize(1024, {NO_NODE, 0});
+}
+
+void SpatialGrid::Insert(NodeIndex index, Vector2 origin) {
+	if (index >= entries.size()) {
+		entries.resize(index + 1, {{0, 0}, 0, 0, NO_NODE, NO_NODE, 0, 0});
+	}
+	if (entries[index].generation == generation) {
+		Erase(index);
+	}
+
+	//keep about two points per bucket
+	if (count >= int(buckets.size()) * 2) {
+		Rehash(buckets.size() * 2);
+	}
+
+	entries[index].origin = origin;
+	entries[index].cellX = Cell(origin.x);
+	entries[index].cellY = Cell(origin.y);
+	entries[index].generation = generation;
+	Link(index);
+	count++;
+}
+
+void SpatialGrid::Erase(NodeIndex index) {
+	if (index >= entries.size() || entries[index].generation != generation) {
+		return;
+	}
+
+	Entry& entry = entries[index];
+	if (entry.prev == NO_NODE) {
+		Head(entry.bucket) = entry.next;
+	}
+	else {
+		entries[entry.prev].next = entry.next;
+	}
+	if (entry.next != NO_NODE) {
+		entries[entry.next].prev = entry.prev;
+	}
+
+	entry.generation = 0;
+	count--;
+}
+
+void SpatialGrid::Clear() {
+	//everything stamped with the old generation is gone
+	generation++;
+	count = 0;
+}
+
+void SpatialGrid::Reserve(NodeIndex points) {
+	if (points > entries.size()) {
+		entries.reserve(points);
+	}
+
+	std::size_t bucketCount = buckets.size();
+	while (bucketCount * 2 < points) {
+		bucketCount *= 2;
+	}
+	if (bucketCount != buckets.size()) {
+		Rehash(bucketCount);
+	}
+}
+
+NodeIndex SpatialGrid::FindNearest(Vector2 point, double radius) {
+	NodeIndex nearest = NO_NODE;
+	double best = radius * radius;
+
+	ForEachInCells(Cell(point.x - radius), Cell(point.y - radius), Cell(point.x + radius), Cell(point.y + radius), [&](NodeIndex index, Vector2 origin) {
+		double d = (origin - point).SquaredLength();
+		if (d <= best) {
+			best = d;
+			nearest = index;
+		}
+	});
+
+	return nearest;
+}
+
+void SpatialGrid::FindInRadius(Vector2 point, double radius, std::vector<NodeIndex>* results) {
+	double limit = radius * radius;
+	ForEachInCells(Cell(point.x - radius), Cell(point.y - radius), Cell(point.x + radius), Cell(point.y + radius), [&](NodeIndex index, Vector2 origin) {
+		if ((origin - point).SquaredLength() <= limit) {
+			results->push_back(index);
+		}
+	});
+}
+
+void SpatialGrid::FindInBox(BoundingBox const& box, std::vector<NodeIndex>* results) {
+	if (box.Empty()) {
+		return;
+	}
+	ForEachInCells(Cell(box.minX), Cell(box.minY), Cell(box.maxX), Cell(box.maxY), [&](NodeIndex index, Vector2 origin) {
+		if (box.Contains(origin)) {
+			results->push_back(index);
+		}
+	});
+}
+
+int SpatialGrid::Size() {
+	return count;
+}
+
+int SpatialGrid::Cell(double v) {
+	return int(std::floor(v / cellSize));
+}
+
+std::uint32_t SpatialGrid::Hash(int cellX, int cellY) {
+	std::uint32_t h = std::uint32_t(cellX) * 73856093u ^ std::uint32_t(cellY) * 19349663u;
+	return (h ^ (h >> 16)) & (buckets.size() - 1);
+}
+
+NodeIndex& SpatialGrid::Head(std::uint32_t bucket) {
+	//stale buckets are empty
+	Bucket& b = buckets[bucket];
+	if (b.generation != generation) {
+		b.head = NO_NODE;
+		b.generation = generation;
+	}
+	return b.head;
+}
+
+void SpatialGrid::Link(NodeIndex index) {
+	Entry& entry = entries[index];
+	entry.bucket = Hash(entry.cellX, entry.cellY);
+	NodeIndex& head = Head(entry.bucket);
+
+	entry.prev = NO_NODE;
+	entry.next = head;
+	if (head != NO_NODE) {
+		entries[head].prev = index;
+	}
+	head = index;
+}
+
+void SpatialGrid::Rehash(std::size_t bucketCount) {
+	buckets.assign(bucketCount, {NO_NODE, 0});
+	for (NodeIndex i = 0; i < entries.size(); i++) {
+		if (entries[i].generation == generation) {
+			Link(i);
+		}
+	}
+}
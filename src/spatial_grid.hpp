@@ -0,0 +1,141 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "bounding_box.hpp"
+#include "vector2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//nodes are addressed by their slot in the owning NodeTree
+typedef std::uint32_t NodeIndex;
+constexpr NodeIndex NO_NODE = UINT32_MAX;
+
+//DOCS: SpatialGrid buckets points into square cells, hashed into a table that grows with the point count
+//DOCS: Clear() is O(1), the stale buckets and entries are recognized by their generation
+class SpatialGrid {
+public:
+	SpatialGrid(double cellSize = 16);
+	~SpatialGrid() = default;
+
+	//moves the point if it's already in the grid
+	void Insert(NodeIndex index, Vector2 origin);
+	void Erase(NodeIndex index);
+	void Clear();
+	void Reserve(NodeIndex points); //sizes the table up front, rather than rehashing as it fills
+
+	//like Insert() for each index, with origin(i) giving the new origin of indices[i]
+	//moving a good part of the grid relinks the whole table instead, which touches far less memory
+	template<typename Fn>
+	void MoveMany(NodeIndex const* indices, int n, Fn origin);
+
+	//the closest point within the radius, or NO_NODE
+	NodeIndex FindNearest(Vector2 point, double radius);
+	void FindInRadius(Vector2 point, double radius, std::vector<NodeIndex>* results);
+	void FindInBox(BoundingBox const& box, std::vector<NodeIndex>* results);
+
+	int Size();
+
+private:
+	struct Entry {
+		Vector2 origin;
+		int cellX, cellY;
+		NodeIndex next;
+		NodeIndex prev;
+		std::uint32_t bucket;
+		std::uint32_t generation; //matches the grid's while the entry is live
+	};
+
+	struct Bucket {
+		NodeIndex head;
+		std::uint32_t generation;
+	};
+
+	int Cell(double v);
+	std::uint32_t Hash(int cellX, int cellY);
+	NodeIndex& Head(std::uint32_t bucket);
+	void Link(NodeIndex index);
+	void Rehash(std::size_t bucketCount);
+
+	//fn(NodeIndex, Vector2) for each point in the given range of cells
+	template<typename Fn>
+	void ForEachInCells(int x1, int y1, int x2, int y2, Fn fn);
+
+	double cellSize;
+	std::vector<Entry> entries; //indexed like the nodes
+	std::vector<Bucket> buckets;
+	std::uint32_t generation = 1;
+	int count = 0;
+};
+
+template<typename Fn>
+void SpatialGrid::MoveMany(NodeIndex const* indices, int n, Fn origin) {
+	if (n < count / 4) {
+		for (int i = 0; i < n; i++) {
+			Insert(indices[i], origin(i));
+		}
+		return;
+	}
+
+	//the links are rebuilt afterwards, so the points only need their new cells
+	for (int i = 0; i < n; i++) {
+		if (indices[i] >= entries.size() || entries[indices[i]].generation != generation) {
+			Insert(indices[i], origin(i));
+			continue;
+		}
+		Entry& entry = entries[indices[i]];
+		entry.origin = origin(i);
+		entry.cellX = Cell(entry.origin.x);
+		entry.cellY = Cell(entry.origin.y);
+	}
+	Rehash(buckets.size());
+}
+
+template<typename Fn>
+void SpatialGrid::ForEachInCells(int x1, int y1, int x2, int y2, Fn fn) {
+	//when the range covers more cells than there are points, just check every point
+	if (double(x2 - x1 + 1) * (y2 - y1 + 1) > count) {
+		for (NodeIndex i = 0; i < entries.size(); i++) {
+			Entry& entry = entries[i];
+			if (entry.generation != generation) {
+				continue;
+			}
+			if (entry.cellX >= x1 && entry.cellX <= x2 && entry.cellY >= y1 && entry.cellY <= y2) {
+				fn(i, entry.origin);
+			}
+		}
+		return;
+	}
+
+	for (int cellY = y1; cellY <= y2; cellY++) {
+		for (int cellX = x1; cellX <= x2; cellX++) {
+			for (NodeIndex it = Head(Hash(cellX, cellY)); it != NO_NODE; it = entries[it].next) {
+				//skip the other cells that share this bucket
+				Entry& entry = entries[it];
+				if (entry.cellX == cellX && entry.cellY == cellY) {
+					fn(it, entry.origin);
+				}
+			}
+		}
+	}
+}
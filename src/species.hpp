@@ -0,0 +1,165 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "branch_random.hpp"
+#include "node.hpp"
+#include "tree_grower.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//DOCS: A species is a struct of constexpr growth parameters, and growSpecies<Species>() is compiled for each one
+//DOCS: the parameters are folded into the growth loop, a feature a species doesn't use isn't checked per leaf
+//DOCS: a plant grows as a trunk that doesn't fork, then forks once, then branches freely and can flower
+//DOCS: depths are tree heights, the root alone is 1, and chances are 1 in N, where 0 is never
+
+//the example plant
+struct CherryBlossom {
+	static constexpr int maxLeaves = 800; //stops growing here
+	static constexpr int length = 10; //of each new branch
+	static constexpr int spread = 50; //range of angles a branch grows in, in degrees
+	static constexpr int sproutChance = 10;
+	static constexpr int trunkDepth = 6;
+	static constexpr int trunkSpread = 20;
+	static constexpr int flowerDepth = 10;
+	static constexpr int flowerChance = 10;
+};
+
+//tall and narrow, with no flowers
+struct Pine {
+	static constexpr int maxLeaves = 1500;
+	static constexpr int length = 8;
+	static constexpr int spread = 24;
+	static constexpr int sproutChance = 3;
+	static constexpr int trunkDepth = 12;
+	static constexpr int trunkSpread = 8;
+	static constexpr int flowerDepth = 0;
+	static constexpr int flowerChance = 0;
+};
+
+//a short trunk, then long, wide branches
+struct Willow {
+	static constexpr int maxLeaves = 600;
+	static constexpr int length = 14;
+	static constexpr int spread = 90;
+	static constexpr int sproutChance = 5;
+	static constexpr int trunkDepth = 4;
+	static constexpr int trunkSpread = 16;
+	static constexpr int flowerDepth = 0;
+	static constexpr int flowerChance = 0;
+};
+
+//a small, dense shrub that flowers early and often
+struct Azalea {
+	static constexpr int maxLeaves = 400;
+	static constexpr int length = 8;
+	static constexpr int spread = 70;
+	static constexpr int sproutChance = 3;
+	static constexpr int trunkDepth = 2;
+	static constexpr int trunkSpread = 30;
+	static constexpr int flowerDepth = 4;
+	static constexpr int flowerChance = 3;
+};
+
+//BranchRandom::TagKey() for the flower rolls
+constexpr std::uint64_t flowerTag = 1;
+
+//one growth step at one stage of the plant's life
+template<typename Species, int spread, int sproutChance, bool flowering>
+void growSpeciesStep(NodeTree* tree, TreeGrower* grower) {
+	constexpr bool flowers = Species::flowerChance != 0;
+
+	//only the current leaves grow, each one only reads itself
+	grower->Grow(tree, tree->GetLeaves(), [](NodeTree* tree, NodeIndex leaf, std::vector<Sprout>* sprouts) {
+		Node* node = tree->GetNode(leaf);
+		if constexpr (flowers) {
+			if (node->GetType() == Node::Type::FLOWER) {
+				return;
+			}
+		}
+
+		Sprout branches[2];
+		int count = sproutBranch<spread, sproutChance, Species::length>(tree, leaf, branches);
+		sprouts->insert(sprouts->end(), branches, branches + count);
+
+		if constexpr (flowers && flowering) {
+			//a stream of its own, the node's next growth draws from births + count on its plain key
+			BranchRandom rng(tree->GetSeed(), BranchRandom::TagKey(node->GetKey(), flowerTag), node->GetBirths());
+			std::uint32_t rolls[2];
+			rng.Fill(rolls, 2);
+
+			if (rolls[0] % Species::flowerChance == 0) {
+				sprouts->push_back({leaf, int(rolls[1] % (spread*2)) + node->GetDirection() - spread, node->GetLength(), Node::Type::FLOWER});
+			}
+		}
+	});
+
+	//the old leaves are stems now
+	for (auto& it : grower->GetFrontier()) {
+		if (!flowers || tree->GetNode(it)->GetType() != Node::Type::FLOWER) {
+			tree->SetType(it, Node::Type::STEM);
+		}
+	}
+
+	//re-mark all non-flower leaves
+	for (auto& it : tree->GetLeaves()) {
+		if (!flowers || tree->GetNode(it)->GetType() != Node::Type::FLOWER) {
+			tree->SetType(it, Node::Type::LEAF);
+		}
+	}
+}
+
+template<typename Species, int spread, int sproutChance>
+void growSpeciesStep(NodeTree* tree, TreeGrower* grower, bool flowering) {
+	if (Species::flowerChance != 0 && flowering) {
+		growSpeciesStep<Species, spread, sproutChance, true>(tree, grower);
+	}
+	else {
+		growSpeciesStep<Species, spread, sproutChance, false>(tree, grower);
+	}
+}
+
+//auto-grow the tree
+template<typename Species>
+void growSpecies(NodeTree* tree, TreeGrower* grower) {
+	static_assert(Species::trunkDepth >= 0 && Species::flowerDepth >= 0 && Species::maxLeaves > 0, "Bad species parameters");
+
+	//maximum plant size
+	if (tree->GetLeafCount() >= Species::maxLeaves) {
+		return;
+	}
+
+	int deepestLeaf = findDeepestLeaf(tree, tree->GetRoot());
+	bool flowering = deepestLeaf >= Species::flowerDepth;
+
+	//shape the trunk
+	if (deepestLeaf < Species::trunkDepth) {
+		growSpeciesStep<Species, Species::trunkSpread, 0>(tree, grower, flowering);
+	}
+	else if (deepestLeaf == Species::trunkDepth) {
+		growSpeciesStep<Species, Species::spread, 1>(tree, grower, flowering);
+	}
+	else {
+		growSpeciesStep<Species, Species::spread, Species::sproutChance>(tree, grower, flowering);
+	}
+}
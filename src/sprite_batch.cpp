@@ -0,0 +1,136 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "sprite_batch.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+void SpriteBatch::Draw(SDL_Texture* texture, SDL_Rect const& src, float x, float y, float w, float h) {
+	Group* group = FindGroup(texture);
+
+	//texture coordinates are normalized
+	float u0 = src.x / group->width;
+	float v0 = src.y / group->height;
+	float u1 = (src.x + src.w) / group->width;
+	float v1 = (src.y + src.h) / group->height;
+
+	SDL_Color white = {255, 255, 255, 255};
+	int base = group->vertices.size();
+
+	group->vertices.push_back({{x, y}, white, {u0, v0}});
+	group->vertices.push_back({{x + w, y}, white, {u1, v0}});
+	group->vertices.push_back({{x + w, y + h}, white, {u1, v1}});
+	group->vertices.push_back({{x, y + h}, white, {u0, v1}});
+
+	//two triangles
+	group->indices.push_back(base);
+	group->indices.push_back(base + 1);
+	group->indices.push_back(base + 2);
+	group->indices.push_back(base);
+	group->indices.push_back(base + 2);
+	group->indices.push_back(base + 3);
+}
+
+void SpriteBatch::Draw(Image* image, Sint16 x, Sint16 y, double scaleX, double scaleY) {
+	if (!image->GetTexture()) {
+		throw(std::logic_error("No image texture to draw"));
+	}
+	SDL_Rect clip = image->GetClip();
+	Draw(image->GetTexture(), clip, x, y, Uint16(clip.w * scaleX), Uint16(clip.h * scaleY));
+}
+
+void SpriteBatch::Flush(SDL_Renderer* renderer) {
+	Submit(renderer);
+	Clear();
+}
+
+void SpriteBatch::Submit(SDL_Renderer* renderer) {
+	drawCalls = 0;
+	vertexCount = 0;
+
+	for (int i = 0; i < activeGroups; i++) {
+		Group& group = groups[i];
+		if (group.indices.empty()) {
+			continue;
+		}
+
+		if (SDL_RenderGeometry(renderer, group.texture, group.vertices.data(), group.vertices.size(), group.indices.data(), group.indices.size())) {
+			std::ostringstream msg;
+			msg << "Failed to render a sprite batch; " << SDL_GetError();
+			throw(std::runtime_error(msg.str()));
+		}
+
+		drawCalls++;
+		vertexCount += group.vertices.size();
+	}
+}
+
+void SpriteBatch::Clear() {
+	for (int i = 0; i < activeGroups; i++) {
+		groups[i].vertices.clear();
+		groups[i].indices.clear();
+	}
+
+	activeGroups = 0;
+	lastGroup = 0;
+}
+
+int SpriteBatch::GetDrawCalls() {
+	return drawCalls;
+}
+
+int SpriteBatch::GetVertexCount() {
+	return vertexCount;
+}
+
+SpriteBatch::Group* SpriteBatch::FindGroup(SDL_Texture* texture) {
+	//sprites tend to come in runs
+	if (lastGroup < activeGroups && groups[lastGroup].texture == texture) {
+		return &groups[lastGroup];
+	}
+
+	for (int i = 0; i < activeGroups; i++) {
+		if (groups[i].texture == texture) {
+			lastGroup = i;
+			return &groups[i];
+		}
+	}
+
+	//start a new group
+	if (activeGroups == int(groups.size())) {
+		groups.emplace_back();
+	}
+	Group& group = groups[activeGroups];
+	lastGroup = activeGroups++;
+
+	int w = 0, h = 0;
+	if (SDL_QueryTexture(texture, nullptr, nullptr, &w, &h)) {
+		std::ostringstream msg;
+		msg << "Failed to query a batched texture; " << SDL_GetError();
+		throw(std::runtime_error(msg.str()));
+	}
+	group.texture = texture;
+	group.width = w;
+	group.height = h;
+
+	return &group;
+}
@@ -0,0 +1,70 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "image.hpp"
+
+#include "SDL2/SDL.h"
+
+#include <vector>
+
+//DOCS: SpriteBatch gathers textured quads and submits one SDL_RenderGeometry call per texture
+//DOCS: The groups are drawn in the order their textures first appeared, (requires SDL 2.0.18)
+class SpriteBatch {
+public:
+	SpriteBatch() = default;
+	~SpriteBatch() = default;
+
+	//queue a quad
+	void Draw(SDL_Texture* texture, SDL_Rect const& src, float x, float y, float w, float h);
+	void Draw(Image* image, Sint16 x, Sint16 y, double scaleX = 1.0, double scaleY = 1.0);
+
+	//submit and empty the batch
+	void Flush(SDL_Renderer* renderer);
+
+	//submit, keeping the quads for another Submit()
+	void Submit(SDL_Renderer* renderer);
+	void Clear();
+
+	//stats of the last Submit()
+	int GetDrawCalls();
+	int GetVertexCount();
+
+private:
+	struct Group {
+		SDL_Texture* texture = nullptr;
+		float width = 1;
+		float height = 1;
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	Group* FindGroup(SDL_Texture* texture);
+
+	//the groups are kept between flushes to reuse their buffers
+	std::vector<Group> groups;
+	int activeGroups = 0;
+	int lastGroup = 0;
+
+	int drawCalls = 0;
+	int vertexCount = 0;
+};
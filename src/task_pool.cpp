@@ -0,0 +1,76 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "task_pool.hpp"
+
+TaskPool::TaskPool(int threadCount) {
+	if (threadCount <= 0) {
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount <= 0) {
+		threadCount = 1;
+	}
+
+	for (int i = 0; i < threadCount; i++) {
+		threads.emplace_back(&TaskPool::Work, this);
+	}
+}
+
+TaskPool::~TaskPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (auto& it : threads) {
+		it.join();
+	}
+}
+
+int TaskPool::GetThreadCount() {
+	return threads.size();
+}
+
+void TaskPool::Push(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	wake.notify_one();
+}
+
+void TaskPool::Work() {
+	for (;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() -> bool { return quit || !tasks.empty(); });
+			if (tasks.empty()) {
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
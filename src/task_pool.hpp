@@ -0,0 +1,60 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//DOCS: TaskPool runs queued tasks on its own threads, first in first out
+//DOCS: Unlike WorkerPool the caller doesn't wait, each result comes back through a future
+//NOTE: a task that throws passes the exception on through its future
+class TaskPool {
+public:
+	TaskPool(int threadCount = 0); //0 for one per core
+	~TaskPool(); //finishes the queued tasks first
+
+	template<typename Fn>
+	auto Submit(Fn fn) -> std::future<decltype(fn())> {
+		auto task = std::make_shared<std::packaged_task<decltype(fn())()>>(std::move(fn));
+		std::future<decltype(fn())> result = task->get_future();
+		Push([task]() { (*task)(); });
+		return result;
+	}
+
+	int GetThreadCount();
+
+private:
+	void Push(std::function<void()> task);
+	void Work();
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<std::function<void()>> tasks;
+	bool quit = false;
+};
@@ -21,6 +21,39 @@
 */
 #include "texture_loader.hpp"
 
+#include "atlas_packer.hpp"
+
+#include "SDL2/SDL_image.h"
+
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+
+//runs on the decoding threads, (RGBA32 is easy to blit and to upload)
+static SDL_Surface* decodeImage(std::string path) {
+	SDL_Surface* loaded = IMG_Load(path.c_str());
+	if (!loaded) {
+		std::ostringstream msg;
+		msg << "Failed to load an image file: " << path;
+		msg << "; " << IMG_GetError();
+		throw(std::runtime_error(msg.str()));
+	}
+
+	SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+	if (surface != loaded) {
+		SDL_FreeSurface(loaded);
+	}
+	if (!surface) {
+		std::ostringstream msg;
+		msg << "Failed to convert an image file: " << path;
+		msg << "; " << SDL_GetError();
+		throw(std::runtime_error(msg.str()));
+	}
+
+	return surface;
+}
+
 TextureLoader::TextureLoader() {
 	//EMPTY
 }
@@ -29,41 +62,260 @@ TextureLoader::~TextureLoader() {
 	UnloadAll();
 }
 
-SDL_Texture* TextureLoader::Load(SDL_Renderer* renderer, std::string dirname, std::string fname) {
+TextureHandle TextureLoader::Load(SDL_Renderer* renderer, std::string dirname, std::string fname) {
 	//if this file is already loaded, return the loaded version rather than a new one
-	std::map<std::string, Image>::iterator it = elementMap.find(fname);
-	if (it == elementMap.end()) {
-		elementMap[fname].Load(renderer, dirname + fname);
-		return elementMap[fname].GetTexture();
+	TextureHandle handle = FindHandle(fname);
+	if (handle != NO_TEXTURE) {
+		Wait(renderer, {handle});
+		return handle;
 	}
-	else {
-		return it->second.GetTexture();
+
+	Image image;
+	image.Load(renderer, dirname + fname);
+	handle = Insert(fname);
+	images[handle] = std::move(image);
+	return handle;
+}
+
+TextureHandle TextureLoader::Store(std::string fname, Image&& image) {
+	TextureHandle handle = FindHandle(fname);
+	if (handle == NO_TEXTURE) {
+		handle = Insert(fname);
 	}
+	images[handle] = std::move(image);
+	return handle;
 }
 
-SDL_Texture* TextureLoader::Find(std::string fname) {
-	std::map<std::string, Image>::iterator it = elementMap.find(fname);
-	if (it == elementMap.end()) {
-		return nullptr;
+TextureHandle TextureLoader::LoadAsync(std::string dirname, std::string fname) {
+	TextureHandle handle = FindHandle(fname);
+	if (handle != NO_TEXTURE) {
+		return handle;
+	}
+
+	handle = Insert(fname);
+	states[handle] = TextureState::LOADING;
+	std::string path = dirname + fname;
+	pending.push_back({handle, decoders.Submit([path]() { return decodeImage(path); })});
+	return handle;
+}
+
+TextureState TextureLoader::GetState(TextureHandle handle) {
+	return handle < states.size() ? states[handle] : TextureState::UNLOADED;
+}
+
+int TextureLoader::UploadPending(SDL_Renderer* renderer, std::chrono::microseconds budget) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	//in the order they were asked for, skipping any still decoding
+	std::vector<Pending>::iterator it = pending.begin();
+	while (it != pending.end() && std::chrono::steady_clock::now() - start < budget) {
+		if (it->surface.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+		Upload(renderer, &*it);
+		it = pending.erase(it);
+	}
+
+	return pending.size();
+}
+
+void TextureLoader::Wait(SDL_Renderer* renderer, std::vector<TextureHandle> const& handles) {
+	for (auto& handle : handles) {
+		std::vector<Pending>::iterator it = std::find_if(pending.begin(), pending.end(), [handle](Pending const& p) -> bool {
+			return p.handle == handle;
+		});
+		if (it != pending.end()) {
+			Upload(renderer, &*it);
+			pending.erase(it);
+		}
+
+		if (GetState(handle) == TextureState::FAILED) {
+			throw(std::runtime_error(failures[handle]));
+		}
+	}
+}
+
+TextureHandle TextureLoader::FindHandle(std::string_view fname) {
+	std::map<std::string, TextureHandle, std::less<>>::iterator it = handleMap.find(fname);
+	if (it == handleMap.end()) {
+		return NO_TEXTURE;
 	}
 	else {
-		return it->second.GetTexture();
+		return it->second;
 	}
 }
 
-void TextureLoader::Unload(std::string fname) {
-	elementMap.erase(fname);
+SDL_Texture* TextureLoader::Find(std::string_view fname) {
+	Image* image = FindImage(fname);
+	return image ? image->GetTexture() : nullptr;
+}
+
+Image* TextureLoader::FindImage(std::string_view fname) {
+	return GetImage(FindHandle(fname));
+}
+
+void TextureLoader::LoadAtlas(SDL_Renderer* renderer, std::string dirname, std::vector<std::string> const& fnames, int padding, int pageSize) {
+	//load the new files, as plain pixels
+	std::vector<std::string> names;
+	std::vector<SDL_Surface*> surfaces;
+	std::vector<std::pair<int, int>> sizes;
+	auto freeSurfaces = [&surfaces]() {
+		for (auto& it : surfaces) {
+			SDL_FreeSurface(it);
+		}
+	};
+
+	//decode them side by side
+	std::vector<std::future<SDL_Surface*>> decoding;
+	for (auto& it : fnames) {
+		if (FindHandle(it) != NO_TEXTURE || std::find(names.begin(), names.end(), it) != names.end()) {
+			continue;
+		}
+		std::string path = dirname + it;
+		names.push_back(it);
+		decoding.push_back(decoders.Submit([path]() { return decodeImage(path); }));
+	}
+
+	//collect every one, so a failure doesn't leak the rest
+	std::exception_ptr failure;
+	for (auto& it : decoding) {
+		try {
+			surfaces.push_back(it.get());
+		}
+		catch(...) {
+			if (!failure) {
+				failure = std::current_exception();
+			}
+		}
+	}
+	if (failure) {
+		freeSurfaces();
+		std::rethrow_exception(failure);
+	}
+
+	for (auto& it : surfaces) {
+		//copy the pixels exactly, alpha included
+		SDL_SetSurfaceBlendMode(it, SDL_BLENDMODE_NONE);
+		sizes.push_back({it->w + padding * 2, it->h + padding * 2});
+	}
+
+	if (names.empty()) {
+		return;
+	}
+
+	AtlasPacker packer(pageSize);
+
+	//free the decoded pixels whatever throws below, e.g. the packer for an image bigger than a page
+	try {
+		std::vector<AtlasPacker::Placement> placements = packer.Pack(sizes);
+		std::vector<SDL_Rect> clips(names.size());
+
+		for (int page = 0; page < packer.GetPageCount(); page++) {
+			SDL_Surface* pixels = SDL_CreateRGBSurfaceWithFormat(0, pageSize, packer.GetPageHeight(page), 32, SDL_PIXELFORMAT_RGBA32);
+			if (!pixels) {
+				std::ostringstream msg;
+				msg << "Failed to create an atlas page; " << SDL_GetError();
+				throw(std::runtime_error(msg.str()));
+			}
+
+			for (int i = 0; i < int(names.size()); i++) {
+				if (placements[i].page != page) {
+					continue;
+				}
+
+				//the image, then its edges stretched out over the padding
+				SDL_Surface* s = surfaces[i];
+				int x = placements[i].x, y = placements[i].y, w = s->w, h = s->h, p = padding;
+				SDL_Rect body = {x + p, y + p, w, h};
+				SDL_BlitSurface(s, nullptr, pixels, &body);
+
+				if (p > 0) {
+					SDL_Rect edges[8][2] = {
+						{{0, 0, w, 1}, {x + p, y, w, p}}, //top
+						{{0, h - 1, w, 1}, {x + p, y + p + h, w, p}}, //bottom
+						{{0, 0, 1, h}, {x, y + p, p, h}}, //left
+						{{w - 1, 0, 1, h}, {x + p + w, y + p, p, h}}, //right
+						{{0, 0, 1, 1}, {x, y, p, p}}, //corners
+						{{w - 1, 0, 1, 1}, {x + p + w, y, p, p}},
+						{{0, h - 1, 1, 1}, {x, y + p + h, p, p}},
+						{{w - 1, h - 1, 1, 1}, {x + p + w, y + p + h, p, p}}
+					};
+					for (auto& it : edges) {
+						SDL_BlitScaled(s, &it[0], pixels, &it[1]);
+					}
+				}
+
+				clips[i] = body;
+			}
+
+			atlasPages.emplace_back();
+			try {
+				atlasPages.back().Load(renderer, pixels);
+			}
+			catch(...) {
+				SDL_FreeSurface(pixels);
+				throw;
+			}
+			SDL_FreeSurface(pixels);
+
+			//the new entries point into the page
+			for (int i = 0; i < int(names.size()); i++) {
+				if (placements[i].page == page) {
+					Image& image = images[Insert(names[i])];
+					image.SetTexture(atlasPages.back().GetTexture());
+					image.SetClip(clips[i]);
+				}
+			}
+		}
+	}
+	catch(...) {
+		freeSurfaces();
+		throw;
+	}
+
+	freeSurfaces();
+}
+
+int TextureLoader::GetAtlasPageCount() {
+	return atlasPages.size();
+}
+
+void TextureLoader::Unload(std::string_view fname) {
+	std::map<std::string, TextureHandle, std::less<>>::iterator it = handleMap.find(fname);
+	if (it != handleMap.end()) {
+		images[it->second].Free();
+		states[it->second] = TextureState::UNLOADED;
+		handleMap.erase(it);
+	}
 }
 
 void TextureLoader::UnloadAll() {
-	elementMap.clear();
+	//let the decoding finish, then throw it away
+	for (auto& it : pending) {
+		try {
+			SDL_FreeSurface(it.surface.get());
+		}
+		catch(...) {
+			//EMPTY
+		}
+	}
+	pending.clear();
+
+	handleMap.clear();
+	images.clear();
+	states.clear();
+	failures.clear();
+	atlasPages.clear();
 }
 
 void TextureLoader::UnloadIf(std::function<bool(std::pair<const std::string, Image const&>)> fn) {
-	std::map<std::string, Image>::iterator it = elementMap.begin();
-	while (it != elementMap.end()) {
-		if (fn(*it)) {
-			it = elementMap.erase(it);
+	std::map<std::string, TextureHandle, std::less<>>::iterator it = handleMap.begin();
+	while (it != handleMap.end()) {
+		if (fn({it->first, images[it->second]})) {
+			images[it->second].Free();
+			states[it->second] = TextureState::UNLOADED;
+			it = handleMap.erase(it);
 		}
 		else {
 			++it;
@@ -72,5 +324,32 @@ void TextureLoader::UnloadIf(std::function<bool(std::pair<const std::string, Ima
 }
 
 int TextureLoader::Size() {
-	return elementMap.size();
-}
\ No newline at end of file
+	return handleMap.size();
+}
+
+TextureHandle TextureLoader::Insert(std::string fname) {
+	TextureHandle handle = images.size();
+	images.emplace_back();
+	states.push_back(TextureState::READY);
+	handleMap[fname] = handle;
+	return handle;
+}
+
+void TextureLoader::Upload(SDL_Renderer* renderer, Pending* p) {
+	TextureHandle handle = p->handle;
+	SDL_Surface* surface = nullptr;
+	try {
+		surface = p->surface.get();
+
+		//unloaded while it was decoding
+		if (states[handle] == TextureState::LOADING) {
+			images[handle].Load(renderer, surface);
+			states[handle] = TextureState::READY;
+		}
+	}
+	catch(std::exception& e) {
+		states[handle] = TextureState::FAILED;
+		failures[handle] = e.what();
+	}
+	SDL_FreeSurface(surface);
+}
@@ -23,15 +23,65 @@
 
 #include "image.hpp"
 #include "singleton.hpp"
+#include "task_pool.hpp"
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
+typedef std::uint32_t TextureHandle;
+constexpr TextureHandle NO_TEXTURE = UINT32_MAX;
+
+enum class TextureState {
+	LOADING,
+	READY,
+	FAILED,
+	UNLOADED
+};
+
+//DOCS: TextureLoader keeps one Image per file name, loaded on its own or packed into a shared atlas
+//DOCS: atlas entries point into a page texture, so their clip rects matter, use the Image for them
+//DOCS: each name gets a handle when it's loaded, handles resolve in O(1) and aren't reused until UnloadAll()
+//DOCS: async loads are decoded on a TaskPool, then uploaded by UploadPending() or Wait() on the render thread
+//NOTE: Image pointers are invalidated by loading, hold onto handles instead
+//NOTE: only the decoding is threaded, call everything from the render thread
 class TextureLoader : public Singleton<TextureLoader> {
 public:
-	SDL_Texture* Load(SDL_Renderer*, std::string dirname, std::string fname);
-	SDL_Texture* Find(std::string fname);
-	void Unload(std::string fname);
+	TextureHandle Load(SDL_Renderer*, std::string dirname, std::string fname);
+	TextureHandle Store(std::string fname, Image&& image); //takes over an existing image
+
+	//the handle is usable at once, but draws nothing until its state is READY
+	TextureHandle LoadAsync(std::string dirname, std::string fname);
+	TextureState GetState(TextureHandle handle);
+
+	//uploads the decoded images until the budget runs out, returns how many are still pending
+	int UploadPending(SDL_Renderer*, std::chrono::microseconds budget);
+
+	//blocks until these are uploaded, throws if any of them failed
+	void Wait(SDL_Renderer*, std::vector<TextureHandle> const& handles);
+
+	//packs the files into as few pages as possible, names that are already loaded are left alone
+	//padding repeats each image's edge pixels around it, so scaled drawing doesn't bleed into the neighbours
+	void LoadAtlas(SDL_Renderer*, std::string dirname, std::vector<std::string> const& fnames, int padding = 2, int pageSize = 1024);
+	int GetAtlasPageCount();
+
+	//by handle
+	Image* GetImage(TextureHandle handle) {
+		return handle < images.size() ? &images[handle] : nullptr;
+	}
+
+	//by name, for the rare lookups
+	TextureHandle FindHandle(std::string_view fname);
+	SDL_Texture* Find(std::string_view fname);
+	Image* FindImage(std::string_view fname);
+
+	void Unload(std::string_view fname);
 	void UnloadAll();
 	void UnloadIf(std::function<bool(std::pair<const std::string, Image const&>)> fn);
 
@@ -42,5 +92,23 @@ private:
 	TextureLoader();
 	~TextureLoader();
 
-	std::map<std::string, Image> elementMap;
-};
\ No newline at end of file
+	struct Pending {
+		TextureHandle handle;
+		std::future<SDL_Surface*> surface;
+	};
+
+	TextureHandle Insert(std::string fname);
+	void Upload(SDL_Renderer*, Pending* pending);
+
+	std::map<std::string, TextureHandle, std::less<>> handleMap; //compares with string_view too
+	std::vector<Image> images; //indexed by handle
+	std::vector<TextureState> states; //indexed by handle
+	std::map<TextureHandle, std::string> failures;
+	std::vector<Image> atlasPages;
+
+	std::vector<Pending> pending;
+	TaskPool decoders;
+};
+
+//the images are held by value, if moving one could throw the vectors would copy them as they grow and free the originals' textures
+static_assert(std::is_nothrow_move_constructible<Image>::value && std::is_nothrow_move_assignable<Image>::value, "Image moves can throw");
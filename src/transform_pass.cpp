@@ -0,0 +1,133 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "transform_pass.hpp"
+
+#include "direction_table.hpp"
+
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_PASS_SSE2
+#include <emmintrin.h>
+#endif
+
+//the slots [begin, end) from their parents, which are all before begin
+//a multiply then an add, never fused, so the results match addChildNode() to the bit
+static void transformRange(double* xs, double* ys, std::int32_t const* parents, std::int32_t const* headings, std::int32_t const* lengths, int begin, int end) {
+	int i = begin;
+
+#if defined(__AVX2__)
+	for (; i + 4 <= end; i += 4) {
+		__m128i parent = _mm_loadu_si128(reinterpret_cast<__m128i const*>(parents + i));
+		__m128i heading = _mm_loadu_si128(reinterpret_cast<__m128i const*>(headings + i));
+		__m256d length = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(lengths + i)));
+
+		__m256d x = _mm256_mul_pd(_mm256_i32gather_pd(directionTable.x, heading, 8), length);
+		__m256d y = _mm256_mul_pd(_mm256_i32gather_pd(directionTable.y, heading, 8), length);
+		_mm256_storeu_pd(xs + i, _mm256_add_pd(_mm256_i32gather_pd(xs, parent, 8), x));
+		_mm256_storeu_pd(ys + i, _mm256_add_pd(_mm256_i32gather_pd(ys, parent, 8), y));
+	}
+#elif defined(TRANSFORM_PASS_SSE2)
+	//no gathers, so the lanes are loaded one at a time
+	for (; i + 2 <= end; i += 2) {
+		__m128d length = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(lengths + i)));
+
+		__m128d x = _mm_mul_pd(_mm_set_pd(directionTable.x[headings[i + 1]], directionTable.x[headings[i]]), length);
+		__m128d y = _mm_mul_pd(_mm_set_pd(directionTable.y[headings[i + 1]], directionTable.y[headings[i]]), length);
+		_mm_storeu_pd(xs + i, _mm_add_pd(_mm_set_pd(xs[parents[i + 1]], xs[parents[i]]), x));
+		_mm_storeu_pd(ys + i, _mm_add_pd(_mm_set_pd(ys[parents[i + 1]], ys[parents[i]]), y));
+	}
+#endif
+
+	for (; i < end; i++) {
+		double x = directionTable.x[headings[i]] * lengths[i];
+		double y = directionTable.y[headings[i]] * lengths[i];
+		xs[i] = xs[parents[i]] + x;
+		ys[i] = ys[parents[i]] + y;
+	}
+}
+
+int TransformPass::AddAnchor(Vector2 origin) {
+	if (!levels.empty()) {
+		throw(std::logic_error("TransformPass anchors have to come first"));
+	}
+
+	parents.push_back(-1);
+	headings.push_back(0);
+	lengths.push_back(0);
+	xs.push_back(origin.x);
+	ys.push_back(origin.y);
+	return xs.size() - 1;
+}
+
+void TransformPass::NextLevel() {
+	levels.push_back(xs.size());
+}
+
+int TransformPass::AddNode(int parent, int direction, int length) {
+	if (levels.empty() || parent < 0 || parent >= levels.back()) {
+		throw(std::logic_error("TransformPass parents have to be in an earlier level"));
+	}
+
+	//the same wrapping as the direction table
+	int heading = direction % 360;
+	if (heading < 0) {
+		heading += 360;
+	}
+
+	parents.push_back(parent);
+	headings.push_back(heading);
+	lengths.push_back(length);
+	xs.push_back(0);
+	ys.push_back(0);
+	return xs.size() - 1;
+}
+
+void TransformPass::Run() {
+	for (std::size_t level = 0; level < levels.size(); level++) {
+		int end = level + 1 < levels.size() ? levels[level + 1] : Size();
+		transformRange(xs.data(), ys.data(), parents.data(), headings.data(), lengths.data(), levels[level], end);
+	}
+}
+
+void TransformPass::Clear() {
+	parents.clear();
+	headings.clear();
+	lengths.clear();
+	xs.clear();
+	ys.clear();
+	levels.clear();
+}
+
+Vector2 TransformPass::GetOrigin(int slot) {
+	return {xs[slot], ys[slot]};
+}
+
+int TransformPass::GetParent(int slot) {
+	return parents[slot];
+}
+
+int TransformPass::Size() {
+	return xs.size();
+}
@@ -0,0 +1,60 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "vector2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//DOCS: TransformPass recomputes positions from headings and lengths, with one flat array per field
+//DOCS: the first level holds fixed anchors, and every later node's parent is in an earlier level
+//DOCS: so a whole level can be computed at once, several nodes to a register where the target allows
+//NOTE: the AVX2 loop needs a build that targets it, like -mavx2, otherwise x86 gets SSE2 and anything else a plain loop
+class TransformPass {
+public:
+	TransformPass() = default;
+	~TransformPass() = default;
+
+	//a position that's already known, only before the first NextLevel()
+	int AddAnchor(Vector2 origin);
+
+	//parent is a slot from an earlier level, returns the new node's slot
+	void NextLevel();
+	int AddNode(int parent, int direction, int length);
+
+	//each node ends up at its parent's origin + the heading's unit vector * length, like addChildNode()
+	void Run();
+	void Clear();
+
+	Vector2 GetOrigin(int slot);
+	int GetParent(int slot);
+	int Size();
+
+private:
+	std::vector<std::int32_t> parents;
+	std::vector<std::int32_t> headings; //0 to 359
+	std::vector<std::int32_t> lengths;
+	std::vector<double> xs;
+	std::vector<double> ys;
+	std::vector<int> levels; //the first slot of each level after the anchors
+};
@@ -0,0 +1,316 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "tree_file.hpp"
+
+#include "node_visitor.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//the arrays, in file order
+enum TreeFileField {
+	TYPES,
+	DIRECTIONS,
+	LENGTHS,
+	ORIGINS,
+	KEYS,
+	BIRTHS,
+	ENDS,
+	FIELD_COUNT
+};
+
+constexpr std::size_t fieldSizes[FIELD_COUNT] = {
+	sizeof(std::uint8_t),
+	sizeof(std::int32_t),
+	sizeof(std::int32_t),
+	sizeof(Vector2),
+	sizeof(std::uint64_t),
+	sizeof(std::int32_t),
+	sizeof(std::uint32_t)
+};
+
+constexpr char fileMagic[8] = {'B', 'O', 'N', 'S', 'A', 'I', 'T', 'R'};
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+struct TreeFileHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint32_t nodeCount;
+	std::uint32_t reserved;
+	std::uint64_t seed;
+	std::uint64_t offsets[FIELD_COUNT]; //from the start of the file, 8 byte aligned
+};
+
+static_assert(std::is_pod<TreeFileHeader>::value, "TreeFileHeader is not a POD");
+
+//-------------------------
+//TreeFile
+//-------------------------
+
+void TreeFile::Open(std::string fname) {
+	Close();
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		std::ostringstream msg;
+		msg << "Failed to open a tree file: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	//the view outlives both handles
+	LARGE_INTEGER length;
+	if (GetFileSizeEx(handle, &length) && length.QuadPart > 0) {
+		HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			size = data ? std::size_t(length.QuadPart) : 0;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(handle);
+#else
+	int fd = open(fname.c_str(), O_RDONLY);
+	if (fd == -1) {
+		std::ostringstream msg;
+		msg << "Failed to open a tree file: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	//the mapping outlives the descriptor
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED) {
+			data = mapped;
+			size = info.st_size;
+		}
+	}
+	close(fd);
+#endif
+
+	if (!data) {
+		std::ostringstream msg;
+		msg << "Failed to map a tree file: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	//only the header is checked here, NodeTree::Load() checks the links
+	TreeFileHeader const* header = static_cast<TreeFileHeader const*>(data);
+	std::ostringstream msg;
+
+	if (size < sizeof(TreeFileHeader) || std::memcmp(header->magic, fileMagic, sizeof(fileMagic))) {
+		msg << "Not a tree file: " << fname;
+	}
+	else if (header->byteOrder != byteOrderMark) {
+		msg << "Tree file has the wrong byte order: " << fname;
+	}
+	else if (header->version != version) {
+		msg << "Unsupported tree file version " << header->version << ": " << fname;
+	}
+	else if (header->nodeCount == 0 || header->nodeCount >= NO_NODE) {
+		msg << "Tree file has a bad node count: " << fname;
+	}
+	else {
+		for (int i = 0; i < FIELD_COUNT; i++) {
+			std::uint64_t offset = header->offsets[i];
+			if (offset < sizeof(TreeFileHeader) || offset % 8 || offset > size || (size - offset) / fieldSizes[i] < header->nodeCount) {
+				msg << "Tree file is truncated or corrupt: " << fname;
+				break;
+			}
+		}
+	}
+
+	if (!msg.str().empty()) {
+		Close();
+		throw(std::runtime_error(msg.str()));
+	}
+}
+
+void TreeFile::Close() {
+	if (!data) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+int TreeFile::Size() {
+	return data ? static_cast<TreeFileHeader const*>(data)->nodeCount : 0;
+}
+
+std::uint64_t TreeFile::GetSeed() {
+	return data ? static_cast<TreeFileHeader const*>(data)->seed : 0;
+}
+
+std::uint8_t const* TreeFile::GetTypes() {
+	return GetArray<std::uint8_t>(TYPES);
+}
+
+std::int32_t const* TreeFile::GetDirections() {
+	return GetArray<std::int32_t>(DIRECTIONS);
+}
+
+std::int32_t const* TreeFile::GetLengths() {
+	return GetArray<std::int32_t>(LENGTHS);
+}
+
+Vector2 const* TreeFile::GetOrigins() {
+	return GetArray<Vector2>(ORIGINS);
+}
+
+std::uint64_t const* TreeFile::GetKeys() {
+	return GetArray<std::uint64_t>(KEYS);
+}
+
+std::int32_t const* TreeFile::GetBirths() {
+	return GetArray<std::int32_t>(BIRTHS);
+}
+
+std::uint32_t const* TreeFile::GetEnds() {
+	return GetArray<std::uint32_t>(ENDS);
+}
+
+NodeArrays TreeFile::GetArrays() {
+	NodeArrays arrays;
+	arrays.count = Size();
+	arrays.types = GetTypes();
+	arrays.directions = GetDirections();
+	arrays.lengths = GetLengths();
+	arrays.origins = GetOrigins();
+	arrays.keys = GetKeys();
+	arrays.births = GetBirths();
+	arrays.ends = GetEnds();
+	return arrays;
+}
+
+template<typename T>
+T const* TreeFile::GetArray(int field) {
+	if (!data) {
+		return nullptr;
+	}
+	std::uint64_t offset = static_cast<TreeFileHeader const*>(data)->offsets[field];
+	return reinterpret_cast<T const*>(static_cast<char const*>(data) + offset);
+}
+
+//-------------------------
+//public functions
+//-------------------------
+
+void saveTree(NodeTree* tree, std::string fname) {
+	//the stored origins have to be current
+	tree->UpdateOrigins();
+
+	int count = tree->GetNode(tree->GetRoot())->GetNodeCount();
+
+	//flatten the tree in depth first order, each subtree is contiguous
+	std::vector<std::uint8_t> types;
+	std::vector<std::int32_t> directions;
+	std::vector<std::int32_t> lengths;
+	std::vector<Vector2> origins;
+	std::vector<std::uint64_t> keys;
+	std::vector<std::int32_t> births;
+	std::vector<std::uint32_t> ends;
+
+	types.reserve(count);
+	directions.reserve(count);
+	lengths.reserve(count);
+	origins.reserve(count);
+	keys.reserve(count);
+	births.reserve(count);
+	ends.reserve(count);
+
+	forEachNode(tree, tree->GetRoot(), [&](Node* node) -> int {
+		ends.push_back(types.size() + node->GetNodeCount());
+		types.push_back(node->GetType());
+		directions.push_back(node->GetDirection());
+		lengths.push_back(node->GetLength());
+		origins.push_back(node->GetOrigin());
+		keys.push_back(node->GetKey());
+		births.push_back(node->GetBirths());
+		return Visit::CONTINUE;
+	});
+
+	void const* arrays[FIELD_COUNT] = {types.data(), directions.data(), lengths.data(), origins.data(), keys.data(), births.data(), ends.data()};
+
+	TreeFileHeader header = {};
+	std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.version = TreeFile::version;
+	header.byteOrder = byteOrderMark;
+	header.nodeCount = count;
+	header.seed = tree->GetSeed();
+
+	std::uint64_t offset = sizeof(TreeFileHeader);
+	for (int i = 0; i < FIELD_COUNT; i++) {
+		offset = (offset + 7) / 8 * 8;
+		header.offsets[i] = offset;
+		offset += fieldSizes[i] * count;
+	}
+
+	std::ofstream os(fname, std::ios::binary | std::ios::trunc);
+	if (!os.is_open()) {
+		std::ostringstream msg;
+		msg << "Failed to open a tree file for writing: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+
+	os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	std::uint64_t written = sizeof(header);
+	for (int i = 0; i < FIELD_COUNT; i++) {
+		constexpr char padding[8] = {};
+		os.write(padding, header.offsets[i] - written);
+		os.write(static_cast<char const*>(arrays[i]), fieldSizes[i] * count);
+		written = header.offsets[i] + fieldSizes[i] * count;
+	}
+
+	if (!os) {
+		std::ostringstream msg;
+		msg << "Failed to write a tree file: " << fname;
+		throw(std::runtime_error(msg.str()));
+	}
+}
+
+void loadTree(NodeTree* tree, std::string fname) {
+	TreeFile file(fname);
+	tree->Load(file.GetArrays());
+	tree->SetSeed(file.GetSeed());
+}
@@ -0,0 +1,72 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "node.hpp"
+#include "vector2.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//DOCS: TreeFile is a read-only view of a saved NodeTree, mapped straight from disk
+//DOCS: the file is a header followed by the NodeArrays
+//DOCS: opening only checks the header, the arrays are used in place without any parsing
+//NOTE: the arrays are in the byte order of the machine that saved them, other files are rejected
+class TreeFile {
+public:
+	static constexpr std::uint32_t version = 1;
+
+	TreeFile() = default;
+	TreeFile(std::string fname) { Open(fname); }
+	~TreeFile() { Close(); }
+
+	TreeFile(TreeFile const&) = delete;
+	TreeFile& operator=(TreeFile const&) = delete;
+
+	void Open(std::string fname);
+	void Close();
+
+	int Size();
+	std::uint64_t GetSeed();
+
+	//one entry per node, valid until Close()
+	std::uint8_t const* GetTypes();
+	std::int32_t const* GetDirections();
+	std::int32_t const* GetLengths();
+	Vector2 const* GetOrigins();
+	std::uint64_t const* GetKeys();
+	std::int32_t const* GetBirths();
+	std::uint32_t const* GetEnds();
+	NodeArrays GetArrays(); //all of the above
+
+private:
+	template<typename T>
+	T const* GetArray(int field);
+
+	void* data = nullptr;
+	std::size_t size = 0;
+};
+
+//public functions
+void saveTree(NodeTree* tree, std::string fname); //brings the origins up to date first
+void loadTree(NodeTree* tree, std::string fname);
@@ -0,0 +1,43 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "tree_grower.hpp"
+
+TreeGrower::TreeGrower(int threadCount): pool(threadCount) {
+	//EMPTY
+}
+
+std::vector<NodeIndex> const& TreeGrower::GetFrontier() {
+	return frontier;
+}
+
+int TreeGrower::GetThreadCount() {
+	return pool.GetThreadCount();
+}
+
+void TreeGrower::Merge(NodeTree* tree, int chunks) {
+	for (int i = 0; i < chunks; i++) {
+		for (auto& it : buffers[i]) {
+			NodeIndex child = addChildNode(tree, it.parent, it.direction, it.length);
+			tree->SetType(child, it.type);
+		}
+	}
+}
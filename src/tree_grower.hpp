@@ -0,0 +1,79 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include "node.hpp"
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <vector>
+
+//DOCS: TreeGrower grows a whole frontier in two phases:
+//DOCS: the leaves are split across a WorkerPool, and each chunk plans its sprouts into its own buffer without writing to the tree
+//DOCS: then the buffers are linked into the tree in leaf order, so the result doesn't depend on the thread count
+class TreeGrower {
+public:
+	TreeGrower(int threadCount = 0); //0 for one per core
+	~TreeGrower() = default;
+
+	//plan is called as plan(NodeTree*, NodeIndex leaf, std::vector<Sprout>* sprouts)
+	template<typename Plan>
+	void Grow(NodeTree* tree, std::vector<NodeIndex> const& leaves, Plan plan);
+
+	//the leaves of the last Grow()
+	std::vector<NodeIndex> const& GetFrontier();
+	int GetThreadCount();
+
+private:
+	void Merge(NodeTree* tree, int chunks);
+
+	//frontiers smaller than this aren't split
+	static constexpr int minChunkSize = 512;
+
+	WorkerPool pool;
+	std::vector<NodeIndex> frontier;
+	std::vector<std::vector<Sprout>> buffers;
+};
+
+template<typename Plan>
+void TreeGrower::Grow(NodeTree* tree, std::vector<NodeIndex> const& leaves, Plan plan) {
+	//the tree's own leaf set changes while merging
+	frontier.assign(leaves.begin(), leaves.end());
+
+	int chunks = std::max(1, std::min<int>(pool.GetThreadCount(), frontier.size() / minChunkSize));
+	if (int(buffers.size()) < chunks) {
+		buffers.resize(chunks);
+	}
+
+	pool.ParallelFor(chunks, [&](int chunk) {
+		std::vector<Sprout>* sprouts = &buffers[chunk];
+		sprouts->clear();
+
+		std::size_t begin = frontier.size() * chunk / chunks;
+		std::size_t end = frontier.size() * (chunk + 1) / chunks;
+		for (std::size_t i = begin; i < end; i++) {
+			plan(tree, frontier[i], sprouts);
+		}
+	});
+
+	Merge(tree, chunks);
+}
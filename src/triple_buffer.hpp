@@ -0,0 +1,66 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include <atomic>
+
+//DOCS: TripleBuffer hands the latest of a stream of values from one writer thread to one reader thread without locks
+//DOCS: neither side ever waits, the reader just skips the values it was too slow to see
+//NOTE: the writer fills GetBack() and publishes it, the reader only touches GetFront()
+template<typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() = default;
+	~TripleBuffer() = default;
+
+	//writer
+	T* GetBack() {
+		return &buffers[back];
+	}
+
+	void Publish() {
+		//the filled buffer becomes the middle one, flagged as fresh
+		back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+	}
+
+	//reader, returns true if a newer value replaced the front one
+	bool Acquire() {
+		if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+
+	T* GetFront() {
+		return &buffers[front];
+	}
+
+private:
+	static constexpr int indexMask = 3;
+	static constexpr int freshBit = 4;
+
+	T buffers[3];
+	int back = 0;
+	std::atomic<int> middle{1};
+	int front = 2;
+};
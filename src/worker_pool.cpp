@@ -0,0 +1,108 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(int threadCount) {
+	if (threadCount <= 0) {
+		threadCount = std::thread::hardware_concurrency();
+	}
+
+	nextIndex = 0;
+
+	//the calling thread makes up the numbers
+	for (int i = 1; i < threadCount; i++) {
+		threads.emplace_back(&WorkerPool::Work, this);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (auto& it : threads) {
+		it.join();
+	}
+}
+
+void WorkerPool::ParallelFor(int count, std::function<void(int)> const& fn) {
+	//not worth waking anyone for
+	if (threads.empty() || count <= 1) {
+		for (int i = 0; i < count; i++) {
+			fn(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		jobCount = count;
+		nextIndex = 0;
+		busy = threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	//help out, then wait for the stragglers
+	RunJob();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]() -> bool { return busy == 0; });
+	job = nullptr;
+}
+
+int WorkerPool::GetThreadCount() {
+	return threads.size() + 1;
+}
+
+void WorkerPool::Work() {
+	int seen = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() -> bool { return quit || generation != seen; });
+			if (quit) {
+				return;
+			}
+			seen = generation;
+		}
+
+		RunJob();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busy == 0) {
+				done.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::RunJob() {
+	for (int i = nextIndex++; i < jobCount; i = nextIndex++) {
+		(*job)(i);
+	}
+}
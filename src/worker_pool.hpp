@@ -0,0 +1,59 @@
+/* Copyright: (c) Kayne Ruse 2013-2016
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ * 
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ * 
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+*/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//DOCS: WorkerPool keeps a set of threads parked until there's a job to split between them
+//NOTE: jobs must not throw
+class WorkerPool {
+public:
+	WorkerPool(int threadCount = 0); //0 for one per core, the calling thread counts as one
+	~WorkerPool();
+
+	//call fn(i) for every i in [0, count), returns once they've all finished
+	void ParallelFor(int count, std::function<void(int)> const& fn);
+
+	int GetThreadCount();
+
+private:
+	void Work();
+	void RunJob();
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	//the current job
+	std::function<void(int)> const* job = nullptr;
+	int jobCount = 0;
+	std::atomic<int> nextIndex;
+	int busy = 0;
+	int generation = 0;
+	bool quit = false;
+};